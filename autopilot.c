@@ -0,0 +1,148 @@
+/**
+ * @file autopilot.c
+ * @brief A player that plays the game by itself, for the attract mode and for soak tests.
+ *
+ * The autopilot reads the GameContext, not the screen. It ducks under what the dino can
+ * duck under. For anything else it looks ahead along the jump arcs of the rules: for
+ * each arc it follows the obstacle, which moves at a fixed speed, tick by tick through
+ * the jump and checks that the dino is above it whenever they share columns, and that
+ * the obstacle is behind the dino when it lands. It jumps on the last tick a jump still
+ * clears the obstacle, which is the takeoff spawn_obstacle() leaves room for, and holds
+ * the held jump for as long as it rises.
+ *
+ * The look-ahead is done for a jump now and for a jump one tick later, so a decision
+ * costs at most 2 * NUM_JUMP_ARCS * (MAX_JUMP_TICKS + 1) steps of a few additions each,
+ * well within a frame. The test is done on bounding boxes, so it is a little more careful
+ * than the pixel-exact collision test of the game.
+ *
+ * With a jitter, as dino-balance plays it to stand in for a human, the autopilot picks
+ * for every obstacle how many ticks too early or too late it jumps, up to the jitter.
+ * Without one, as on the ChipKIT, it never misses.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include "declare.h" /* Declatations for these labs */
+
+#define DUCK_LEAD 2 // Ticks before the obstacle arrives that the autopilot starts ducking
+
+/**
+ * @brief Prepares the autopilot for a new run.
+ *
+ * @param pilot The autopilot.
+ * @param game The game it plays, just reset.
+ * @param jitter Most ticks the autopilot jumps too early or too late, 0 to always jump in time.
+ */
+void autopilot_reset(Autopilot *pilot, const GameContext *game, int jitter) {
+	pilot->jump = -1;
+	pilot->score = -1;
+	pilot->jitter = jitter;
+	pilot->early = 0;
+	pilot->delay = 0;
+	rng_seed(&pilot->rng, game->seed, RNG_AUTOPILOT_STREAM);
+}
+
+/**
+ * @brief Checks whether a jump taken after a delay clears the obstacle.
+ *
+ * The obstacle sweeps the columns between where it was and where it is on every tick,
+ * and the dino the rows between its heights, like in check_collision().
+ *
+ * @param game The game, with the dino standing on the ground.
+ * @param arc The jump, JUMP_TAPPED or JUMP_HELD.
+ * @param delay Ticks to wait before taking off, 0 to take off on the next tick.
+ * @return 1 if the dino gets over the obstacle and lands behind it, 0 otherwise.
+ */
+int jump_clears(const GameContext *game, int arc, int delay) {
+	const JumpArc *jump = &game->rules->jump_arcs[arc];
+	int need = GROUND_Y - game->obstacle_y; // Rise that puts the dino's feet above the obstacle
+	int width = game->obstacle->width;
+	int left = game->character_x;
+	int right = game->character_x + DINO1_WIDTH;
+	int32_t x_q8 = game->obstacle_x_q8;
+	int last_x = x_q8 >> 8;
+	int last_rise = 0;
+	int tick;
+
+	for(tick = 1; tick <= delay + jump->ticks; tick++) {
+		int rise = tick <= delay ? 0 : jump->rise[tick - delay - 1];
+		int low = rise < last_rise ? rise : last_rise;
+		int x;
+
+		x_q8 -= game->obstacle_speed;
+		x = x_q8 >> 8;
+		if(x < right && last_x + width > left && low < need) {
+			return 0;
+		}
+		last_x = x;
+		last_rise = rise;
+	}
+	return last_x + width <= left;
+}
+
+/**
+ * @brief Picks the buttons to hold on the next tick.
+ *
+ * @param pilot The autopilot of the game.
+ * @param game The game, before the tick is played.
+ * @return The buttons to pass to update_game(), as getbtns() would return them.
+ */
+int autopilot_buttons(Autopilot *pilot, const GameContext *game) {
+	const GameRules *rules = game->rules;
+	const ObstacleClearance *clearance = &rules->clearance[game->obstacle_type - rules->archetypes];
+	int on_ground = game->character_y + game->character_height == GROUND_Y;
+	int arc, delay;
+
+	if(game->score != pilot->score) { // A new obstacle
+		pilot->score = game->score;
+		pilot->jump = -1;
+		if(pilot->jitter) {
+			pilot->early = (int)rng_below(&pilot->rng, 2 * pilot->jitter + 1) - pilot->jitter;
+		}
+	}
+
+	// Keep a held jump rising as long as it goes
+	if(pilot->jump == JUMP_HELD && game->y_velocity < 0) {
+		return BTN4;
+	}
+	if(game->obstacle_x + game->obstacle->width <= game->character_x) {
+		return 0;
+	}
+
+	// The ducking dino reaches further forward, and has to be down before the obstacle reaches it
+	if(clearance->duck) {
+		int32_t distance = game->obstacle_x_q8 - ((game->character_x + DINO_DUCKING1_WIDTH) << 8);
+		return on_ground && distance <= DUCK_LEAD * game->obstacle_speed ? BTN3 : 0;
+	}
+
+	// Take off late, on the tick picked when the last jump in time went by
+	if(pilot->delay > 0) {
+		pilot->delay--;
+		return pilot->delay == 0 ? BTN4 : 0;
+	}
+	if(!on_ground || pilot->jump >= 0) {
+		return 0;
+	}
+
+	// Wait while a jump on the next tick, or as many ticks later as it jumps early, still clears the obstacle
+	int early = pilot->early > 0 ? pilot->early : 0;
+	for(arc = 0; arc < NUM_JUMP_ARCS; arc++) {
+		if(jump_clears(game, arc, early + 1)) {
+			return 0;
+		}
+	}
+	for(delay = early; delay >= 0; delay--) {
+		for(arc = 0; arc < NUM_JUMP_ARCS; arc++) {
+			if(jump_clears(game, arc, delay)) {
+				pilot->jump = arc;
+				pilot->delay = pilot->early < 0 ? -pilot->early : 0;
+				return pilot->delay ? 0 : BTN4;
+			}
+		}
+	}
+	return 0;
+}
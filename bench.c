@@ -0,0 +1,417 @@
+/**
+ * @file bench.c
+ * @brief A micro-benchmark of the drawing primitives, for the ChipKIT and for the host.
+ *
+ * Every primitive is timed at a few positions: lined up with a page, straddling two
+ * pages, and clipped at each edge of the display. Each case is timed for every way of
+ * drawing the same thing: a reference that sets one pixel at a time with set_pixel(), and
+ * each optimized path the drawing code has for it (blit_packed(), the pre-shifted copies,
+ * the compiled blits, draw_rle() and draw_image(), which picks between them). Every
+ * variant has to leave the same pixels as the reference, which is checked after timing it.
+ *
+ * A case is run for BENCH_ROUNDS rounds of clock->calls calls each, and the fastest round
+ * counts, so an interrupt or a busy host in one round does not show. Between rounds the
+ * pixels are cleared and left as if sent, outside the timing. The result of each case is
+ * sent as a line:
+ *
+ *     bench <primitive> <subject> <variant> <x> <y> <cycles per call> <ns per call> ok
+ *
+ * with the times to a tenth, or "-" when the clock cannot tell, and "BAD" instead of "ok"
+ * when the pixels differ from the reference's ("-" for the reference itself and for
+ * display_objects(), which have nothing to be checked against).
+ * The subject is the sprite,
+ * the size of the rectangle, the length of the string or the number drawn. The time
+ * includes the call through a function pointer, a few cycles. tools/dino-bench prints the
+ * lines as a table and compares them with a stored baseline.
+ *
+ * The file is only built with BENCH: by the host tool, and into the firmware by
+ * make BENCH=1, which runs it at power-up and sends the lines over the UART.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#ifdef BENCH
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include "declare.h" /* Declatations for these labs */
+
+#define BENCH_ROUNDS 5
+
+// The drawing code, in display.c
+void set_pixel(int x, int y);
+void clear_pixel(int x, int y);
+char *itoaconv(int num);
+
+// Draws the subject of a case at a position
+typedef void (*BenchDraw)(int x, int y, const void *subject);
+
+static const BenchClock *bench_clock;
+
+// The pixels the reference drew for the case being timed, if it has one
+static uint8_t expected[4][128] __attribute__((aligned(4)));
+static int has_expected;
+
+static const Sprite *const bench_sprites[] = {
+	&dino1, &dino2, &dino_ducking1, &dino_ducking2, &cactus_small, &cactus_big, &bird1, &bird2, &arrow_up, &title,
+};
+static const char *const bench_sprite_names[] = {
+	"dino1", "dino2", "dino_ducking1", "dino_ducking2", "cactus_small", "cactus_big", "bird1", "bird2", "arrow_up", "title",
+};
+
+static char *put_string(char *line, const char *s) {
+	while(*s) {
+		*line++ = *s++;
+	}
+	return line;
+}
+
+/**
+ * @brief Writes a time in tenths as a decimal with one digit after the point.
+ */
+static char *put_tenths(char *line, uint32_t tenths) {
+	line = put_string(line, itoaconv(tenths / 10));
+	*line++ = '.';
+	*line++ = '0' + tenths % 10;
+	return line;
+}
+
+/*
+ * The reference: every pixel set on its own, through the same clipping and dirty
+ * tracking as the rest of the drawing code.
+ */
+
+static void reference_columns(int x, int y, const uint8_t *columns, int count, int rows) {
+	int i, j;
+
+	for(i = 0; i < count; i++) {
+		for(j = 0; j < rows; j++) {
+			if(columns[i] >> j & 1) {
+				set_pixel(x + i, y + j);
+			}
+		}
+	}
+}
+
+static void reference_clear(int x, int y, const void *subject) {
+	for(y = 0; y < 32; y++) {
+		for(x = 0; x < 128; x++) {
+			clear_pixel(x, y);
+		}
+	}
+}
+
+static void reference_fill(int x, int y, const void *subject) {
+	const int *size = subject;
+	int i, j;
+
+	for(j = y; j < y + size[1]; j++) {
+		for(i = x; i < x + size[0]; i++) {
+			set_pixel(i, j);
+		}
+	}
+}
+
+static void reference_string(int x, int y, const void *subject) {
+	const char *s = subject;
+
+	for(; *s; s++, x += FONT_WIDTH + 1) {
+		reference_columns(x, y, font_glyph(*s), FONT_WIDTH, 8);
+	}
+}
+
+static void reference_number(int x, int y, const void *subject) {
+	const char *s = itoaconv(*(const int *)subject);
+
+	for(; *s; s++, x += DIGIT_WIDTH + 1) {
+		reference_columns(x, y, font_glyph(*s), DIGIT_WIDTH, 8);
+	}
+}
+
+static void reference_sprite(int x, int y, const void *subject) {
+	const Sprite *sprite = subject;
+	const uint8_t *data = sprite->data;
+	int row;
+
+	if(sprite->encoding == SPRITE_PACKED) {
+		for(row = 0; row < sprite->height; row += 8) {
+			int rows = sprite->height - row < 8 ? sprite->height - row : 8;
+			reference_columns(x, y + row, data + (row >> 3) * sprite->width, sprite->width, rows);
+		}
+		return;
+	}
+
+	for(row = 0; row < sprite->height; row += 8) {
+		int col = 0;
+		while(col < sprite->width) {
+			col += data[0];
+			reference_columns(x + col, y + row, data + 2, data[1], 8);
+			col += data[1];
+			data += 2 + data[1];
+		}
+	}
+}
+
+/*
+ * The drawing code, called the way the game calls it.
+ */
+
+static void bench_clear(int x, int y, const void *subject) {
+	clear_all_pixels();
+}
+
+static void bench_fill(int x, int y, const void *subject) {
+	const int *size = subject;
+	fill_rectangle(x, y, size[0], size[1]);
+}
+
+static void bench_string(int x, int y, const void *subject) {
+	draw_string(x, y, (char *)subject);
+}
+
+static void bench_number(int x, int y, const void *subject) {
+	draw_number(x, y, *(const int *)subject);
+}
+
+static void bench_image(int x, int y, const void *subject) {
+	draw_image(x, y, subject);
+}
+
+static void bench_packed(int x, int y, const void *subject) {
+	const Sprite *sprite = subject;
+	blit_packed(x, y, sprite->data, sprite->width, sprite->width, sprite->height);
+}
+
+static void bench_preshifted(int x, int y, const void *subject) {
+	draw_preshifted(x, y, subject);
+}
+
+static void bench_compiled(int x, int y, const void *subject) {
+	((const Sprite *)subject)->blit(x, y);
+}
+
+static void bench_rle(int x, int y, const void *subject) {
+	draw_rle(x, y, subject);
+}
+
+/*
+ * display_objects() after marking what it has to send.
+ */
+
+static void bench_send_all(int x, int y, const void *subject) {
+	mark_all_dirty();
+	display_objects();
+}
+
+static void bench_send_span(int x, int y, const void *subject) {
+	mark_dirty(x, y, 20, 8);
+	display_objects();
+}
+
+static void bench_send_nothing(int x, int y, const void *subject) {
+	display_objects();
+}
+
+/**
+ * @brief Checks that the pixels are the ones the reference drew.
+ */
+static int matches_expected(void) {
+	int page, x;
+
+	for(page = 0; page < 4; page++) {
+		for(x = 0; x < 128; x++) {
+			if(pixel_data[page][x] != expected[page][x]) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Times one variant of a case and sends its line.
+ *
+ * @param primitive The primitive the case measures.
+ * @param name The subject, for the line.
+ * @param variant The way of drawing it.
+ * @param draw Draws the subject.
+ * @param x The x-coordinate to draw at.
+ * @param y The y-coordinate to draw at.
+ * @param subject The sprite, size, string or number to draw.
+ */
+static void bench_case(const char *primitive, const char *name, const char *variant, BenchDraw draw, int x, int y, const void *subject) {
+	const BenchClock *clock = bench_clock;
+	uint32_t best = 0xFFFFFFFF;
+	char line[BENCH_LINE_BYTES];
+	char *end = line;
+	int round, i;
+
+	for(round = 0; round < BENCH_ROUNDS; round++) {
+		uint32_t start, ticks;
+
+		clear_all_pixels();
+		for(i = 0; i < 4; i++) { // As if the cleared display had been sent
+			dirty_start[i] = 128;
+			dirty_end[i] = 0;
+		}
+		start = clock->read();
+		for(i = 0; i < clock->calls; i++) {
+			draw(x, y, subject);
+		}
+		ticks = clock->read() - start;
+		if(ticks < best) {
+			best = ticks;
+		}
+	}
+	best = best / clock->calls * 10 + best % clock->calls * 10 / clock->calls; // Tenths of a tick per call
+
+	end = put_string(end, "bench ");
+	end = put_string(end, primitive);
+	*end++ = ' ';
+	end = put_string(end, name);
+	*end++ = ' ';
+	end = put_string(end, variant);
+	*end++ = ' ';
+	end = put_string(end, itoaconv(x));
+	*end++ = ' ';
+	end = put_string(end, itoaconv(y));
+	*end++ = ' ';
+	end = clock->cycles_num ? put_tenths(end, best * clock->cycles_num / clock->cycles_den) : put_string(end, "-");
+	*end++ = ' ';
+	end = put_tenths(end, best * clock->ns_num / clock->ns_den);
+	end = put_string(end, has_expected ? (matches_expected() ? " ok\r\n" : " BAD\r\n") : " -\r\n");
+	*end = 0;
+	clock->send(line);
+}
+
+/**
+ * @brief Times the reference of a case, and keeps its pixels to check the other variants against.
+ */
+static void bench_reference(const char *primitive, const char *name, BenchDraw draw, int x, int y, const void *subject) {
+	has_expected = 0;
+	bench_case(primitive, name, "reference", draw, x, y, subject);
+	store_layer(expected);
+	has_expected = 1;
+}
+
+/**
+ * @brief Times a sprite at one position, with every way the drawing code can draw it there.
+ *
+ * The pre-shifted copies and the compiled blits only work when the sprite is completely
+ * on the display, so they are only timed there.
+ */
+static void bench_sprite(int index, int x, int y) {
+	const Sprite *sprite = bench_sprites[index];
+	const char *name = bench_sprite_names[index];
+	int inside = x >= 0 && y >= 0 && x + sprite->width <= 128 && y + sprite->height <= 32;
+
+	bench_reference("draw_image", name, reference_sprite, x, y, sprite);
+	bench_case("draw_image", name, "draw_image", bench_image, x, y, sprite);
+	if(sprite->encoding == SPRITE_RLE) {
+		bench_case("draw_image", name, "draw_rle", bench_rle, x, y, sprite);
+		return;
+	}
+	bench_case("draw_image", name, "blit_packed", bench_packed, x, y, sprite);
+	if(inside && sprite->shifted) {
+		bench_case("draw_image", name, "preshifted", bench_preshifted, x, y, sprite);
+	}
+	if(inside && sprite->blit) {
+		bench_case("draw_image", name, "compiled", bench_compiled, x, y, sprite);
+	}
+}
+
+/**
+ * @brief Runs every case and sends a line for each.
+ *
+ * Leaves the pixels cleared and the clip rectangle reset.
+ *
+ * @param clock The clock to time the cases with, and where to send the lines.
+ */
+void bench_run(const BenchClock *clock) {
+	static const int rectangles[][4] = {
+		// x, y, width, height
+		{ 0, 0, 128, 32 },   // The whole display
+		{ 0, 8, 128, 8 },    // One page
+		{ 0, 31, 128, 1 },   // The ground
+		{ 10, 5, 40, 10 },   // Straddling two pages
+		{ -10, -4, 30, 12 }, // Clipped at the top left
+		{ 110, 26, 30, 10 }, // Clipped at the bottom right
+	};
+	static const struct {
+		int x;
+		int y;
+		char *s;
+		const char *name;
+	} strings[] = {
+		{ 0, 0, "score: ", "len7" },
+		{ 0, 3, "congratulations", "len15" },
+		{ -20, 8, "highscore: ", "len11" },
+		{ 100, 28, "btn4:start btn2:menu", "len20" },
+	};
+	static const int numbers[][3] = {
+		// x, y, number
+		{ 110, 0, 7 },
+		{ 35, 3, 1234567 },
+		{ 110, 28, 12345 },
+	};
+	int i;
+
+	bench_clock = clock;
+	reset_clip();
+
+	bench_reference("clear_all_pixels", "-", reference_clear, 0, 0, 0);
+	bench_case("clear_all_pixels", "-", "clear_all_pixels", bench_clear, 0, 0, 0);
+
+	for(i = 0; i < sizeof(rectangles) / sizeof(rectangles[0]); i++) {
+		char name[16], *end = name;
+
+		end = put_string(end, itoaconv(rectangles[i][2]));
+		*end++ = 'x';
+		end = put_string(end, itoaconv(rectangles[i][3]));
+		*end = 0;
+		bench_reference("fill_rectangle", name, reference_fill, rectangles[i][0], rectangles[i][1], &rectangles[i][2]);
+		bench_case("fill_rectangle", name, "fill_rectangle", bench_fill, rectangles[i][0], rectangles[i][1], &rectangles[i][2]);
+	}
+
+	for(i = 0; i < sizeof(bench_sprites) / sizeof(bench_sprites[0]); i++) {
+		const Sprite *sprite = bench_sprites[i];
+		int w = sprite->width;
+		int h = sprite->height;
+
+		if(h > 24) {
+			bench_sprite(i, 0, 0);
+			bench_sprite(i, 0, 3);
+			continue;
+		}
+		bench_sprite(i, 40, 8);            // Lined up with a page
+		bench_sprite(i, 40, 11);           // Straddling pages
+		bench_sprite(i, -w / 2, 11);       // Clipped at the left
+		bench_sprite(i, 128 - w / 2, 11);  // Clipped at the right
+		bench_sprite(i, 40, -h / 2);       // Clipped at the top
+		bench_sprite(i, 40, 32 - h / 2);   // Clipped at the bottom
+	}
+
+	for(i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+		bench_reference("draw_string", strings[i].name, reference_string, strings[i].x, strings[i].y, strings[i].s);
+		bench_case("draw_string", strings[i].name, "draw_string", bench_string, strings[i].x, strings[i].y, strings[i].s);
+	}
+
+	for(i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+		char name[16];
+
+		*put_string(name, itoaconv(numbers[i][2])) = 0;
+		bench_reference("draw_number", name, reference_number, numbers[i][0], numbers[i][1], &numbers[i][2]);
+		bench_case("draw_number", name, "draw_number", bench_number, numbers[i][0], numbers[i][1], &numbers[i][2]);
+	}
+
+	has_expected = 0;
+	bench_case("display_objects", "all", "display_objects", bench_send_all, 0, 0, 0);
+	bench_case("display_objects", "span", "display_objects", bench_send_span, 40, 8, 0);
+	bench_case("display_objects", "none", "display_objects", bench_send_nothing, 0, 0, 0);
+
+	clear_all_pixels();
+}
+
+#endif
@@ -27,7 +27,8 @@ const int FPS = 30;
  * This function initializes the peripheral bus clock, sets up output pins,
  * configures SPI as master, initializes the display, sets up timers,
  * enables interrupts for switches, sets up change notice interrupts,
- * initializes input pins, and enables global interrupts.
+ * and initializes input pins, I2C and the UART. Global interrupts are left
+ * disabled, main() enables them once the game is set up.
  */
 void chip_init(void) {
     /*
@@ -123,5 +124,6 @@ void chip_init(void) {
     I2C1CONSET = 1 << 15; // I2C ON
     // I2C1ADD = 0b1010000; // add EEPROM address to I2C1ADD register...THIS MESSED THINGS UP
 
-    enable_interrupt(); // Enable global interrupts
+    /* Initialize UART1 for sending replays */
+    uart_init();
 }
\ No newline at end of file
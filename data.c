@@ -1,411 +1,683 @@
 /**
  * @file data.c
- * @brief Contains the definitions of various arrays of graphics used in the program.
+ * @brief Graphics data used in the program, generated from the images in assets/.
  *
- * This file contains the definitions of arrays for storing graphical data such as
- * dinosaur sprites, cactus sprites, bird sprites, letters, numbers, and an arrow.
- * These arrays are used in the program for rendering graphics on the display.
+ * Generated by tools/assetgen from assets/assets.txt.
+ * Do not edit by hand: edit the images in assets/ and run make.
  *
  * @author Elias Hollstrand
  * @author Mattias Kvist
  *
- * @date 2023-12-077
- *
  * For copyright and licensing, see file COPYING.
  */
 
-#include <stdint.h>   /* Declarations of uint_32 and the like */
-#include <pic32mx.h>  /* Declarations of system-specific addresses etc */
-
-const uint8_t dino1[195] = {
-	0, 0 ,0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 1, 
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0,
-	1, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0,
-	1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 0,
-	0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-	0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-};
-
-const uint8_t const dino2[195] = {
-	0, 0 ,0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 1, 1, 1, 
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0, 
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 0,
-	1, 0, 0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0,
-	1, 1, 0, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 0,
-	0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0,
-	0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0,
-};
-
-const uint8_t const dino_ducking1[200] = {
-	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0,
-	1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-	0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-};
-
-const uint8_t const dino_ducking2[200] = {
-	1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 0,
-	1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-	0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-};
-
-const uint8_t const cactus_small[66] = {
-	0, 0, 1, 1, 0, 0,
-	0, 0, 1, 1, 0, 1,
-	0, 0, 1, 1, 0, 1,
-	1, 0, 1, 1, 0, 1,
-	1, 0, 1, 1, 1, 1,
-	1, 0, 1, 1, 0, 0,
-	1, 1, 1, 1, 0, 0,
-	0, 0, 1, 1, 0, 0,
-	0, 0, 1, 1, 0, 0,
-	0, 0, 1, 1, 0, 0,
-	0, 0, 1, 1, 0, 0,
-};
-
-const uint8_t const cactus_big[112] = {
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	1, 1, 0, 1, 1, 0, 1, 1,
-	1, 1, 0, 1, 1, 0, 1, 1,
-	1, 1, 0, 1, 1, 0, 1, 1,
-	1, 1, 0, 1, 1, 0, 1, 1,
-	1, 1, 1, 1, 1, 1, 1, 1,
-	0, 1, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-	0, 0, 0, 1, 1, 0, 0, 0,
-};
-
-const uint8_t const bird1[72] = {
-	0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0,
-	0, 0, 1, 1, 0, 0, 1, 1, 1, 0, 0, 0,
-	0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-};
-
-const uint8_t const bird2[72] = {
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
-	0, 1, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0,
-	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0,
-	0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
-};
-
-const uint8_t const letters[28][25] = {
-	{ // A
-		0, 1, 1, 1, 0,
-		1, 0, 0, 0, 1, 
-		1, 0, 0, 0, 1, 
-		1, 1, 1, 1, 1, 
-		1, 0, 0, 0, 1, 
-	},
-	{ // B
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 0,
-	},
-	{ // C
-		0, 1, 1, 1, 1,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-		0, 1, 1, 1, 1,
-	},
-	{ // D
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 0,
-	},
-	{ // E
-		1, 1, 1, 1, 1,
-		1, 0, 0, 0, 0,
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 0,
-		1, 1, 1, 1, 1,
-	},
-	{ //F
-		1, 1, 1, 1, 1,
-		1, 0, 0, 0, 0,
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-	},
-	{ // G
-		0, 1, 1, 1, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 1, 1, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 1, 1, 0,
-	},
-	{ // H
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-	},
-	{ // I
-		0, 1, 1, 1, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 1, 1, 1, 0,
-	},
-	{ // J
-		1, 1, 1, 1, 1,
-		0, 0, 0, 0, 1,
-		0, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 1, 1, 0,
-	},
-	{ // K
-		1, 0, 0, 0, 1,
-		1, 0, 0, 1, 0,
-		1, 1, 1, 0, 0,
-		1, 0, 0, 1, 0,
-		1, 0, 0, 0, 1,
-	},
-	{ // L
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-		1, 1, 1, 1, 1,
-	},
-	{ // M
-		1, 0, 0, 0, 1,
-		1, 1, 0, 1, 1,
-		1, 0, 1, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-	},
-	{ // N
-		1, 0, 0, 0, 1,
-		1, 1, 0, 0, 1,
-		1, 0, 1, 0, 1,
-		1, 0, 0, 1, 1,
-		1, 0, 0, 0, 1,
-	},
-	{ // O
-		0, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 1, 1, 0,
-	},
-	{ // P
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 0,
-		1, 0, 0, 0, 0,
-	},
-	{ // Q
-		0, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 1, 1, 1,
-	},
-	{ // R
-		1, 1, 1, 1, 0,
-		1, 0, 0, 0, 1,
-		1, 1, 1, 1, 0,
-		1, 0, 0, 1, 0,
-		1, 0, 0, 0, 1,
-	},
-	{ // S
-		0, 1, 1, 1, 1,
-		1, 0, 0, 0, 0, 
-		0, 1, 1, 1, 0, 
-		0, 0, 0, 0, 1, 
-		1, 1, 1, 1, 0, 
-	},
-	{ // T
-		1, 1, 1, 1, 1,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-	},
-	{ // U
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 1, 1, 0,
-	},
-	{ // V
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		0, 1, 0, 1, 0,
-		0, 0, 1, 0, 0,
-		
-	},
-	{ // W
-		1, 0, 0, 0, 1,
-		1, 0, 0, 0, 1,
-		1, 0, 1, 0, 1,
-		1, 1, 0, 1, 1,
-		1, 0, 0, 0, 1,
-	},
-	{  // X
-		1, 0, 0, 0, 1,
-		0, 1, 0, 1, 0,
-		0, 0, 1, 0, 0,
-		0, 1, 0, 1, 0,
-		1, 0, 0, 0, 1,
-	},
-	{ // Y
-		1, 0, 0, 0, 1,
-		0, 1, 0, 1, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 1, 0, 0,
-	},
-	{ // Z
-		1, 1, 1, 1, 1,
-		0, 0, 0, 1, 0,
-		0, 0, 1, 0, 0,
-		0, 1, 0, 0, 0,
-		1, 1, 1, 1, 1,	
-	},
-	{ // Blank space
-		0, 0, 0, 0, 0,
-		0, 0, 0, 0, 0,
-		0, 0, 0, 0, 0,
-		0, 0, 0, 0, 0,
-		0, 0, 0, 0, 0,
-	},
-	{ // :
-		0, 0, 0, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 0, 0, 0,
-		0, 0, 1, 0, 0,
-		0, 0, 0, 0, 0,
-	},
-};
-
-const uint8_t const numbers[10][20] = {
-	{
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		1, 0, 0, 1,
-		1, 0, 0, 1,
-		0, 1, 1, 0,
-	},
-	{
-		0, 1, 1, 0,
-		1, 0, 1, 0,
-		0, 0, 1, 0,
-		0, 0, 1, 0,
-		0, 1, 1, 1,
-	},
-	{
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 0, 1, 0,
-		0, 1, 0, 0,
-		1, 1, 1, 1,
-	},
-	{	
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 0, 1, 0,
-		1, 0, 0, 1,
-		0, 1, 1, 0,
-
-	},
-	{	
-		1, 0, 0, 1,
-		1, 0, 0, 1,
-		1, 1, 1, 1,
-		0, 0, 0, 1,
-		0, 0, 0, 1,
-	},
-	{
-		1, 1, 1, 1,
-		1, 0, 0, 0,
-		0, 1, 1, 0,
-		0, 0, 0, 1,
-		1, 1, 1, 0,
-	},
-	{
-		0, 1, 1, 1,
-		1, 0, 0, 0,
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 1, 1, 0,
-	},
-	{
-		1, 1, 1, 1,
-		0, 0, 0, 1,
-		0, 0, 1, 0,
-		0, 1, 0, 0,
-		1, 0, 0, 0,
-	},
-	{
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 1, 1, 0,
-	},
-	{
-		0, 1, 1, 0,
-		1, 0, 0, 1,
-		0, 1, 1, 1,
-		0, 0, 0, 1,
-		0, 1, 1, 0,
-	},
-};
-
-const uint8_t const arrow_up[5][5] = {
-	0, 0, 1, 0, 0,
-	0, 1, 1, 1, 0,
-	1, 1, 1, 1, 1,
-	0, 0, 1, 0, 0,
-	0, 0, 1, 0, 0,
+#include <stdint.h>
+#include "declare.h"
+
+/* font: 95 glyphs of 5x5, 475 bytes */
+const uint8_t font[FONT_GLYPHS][FONT_WIDTH] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00 },
+	{ 0x00, 0x00, 0x17, 0x00, 0x00 },
+	{ 0x00, 0x03, 0x00, 0x03, 0x00 },
+	{ 0x0a, 0x1f, 0x0a, 0x1f, 0x0a },
+	{ 0x12, 0x15, 0x1f, 0x15, 0x09 },
+	{ 0x13, 0x0b, 0x04, 0x1a, 0x19 },
+	{ 0x0a, 0x15, 0x15, 0x0a, 0x14 },
+	{ 0x00, 0x00, 0x03, 0x00, 0x00 },
+	{ 0x00, 0x00, 0x0e, 0x11, 0x00 },
+	{ 0x00, 0x11, 0x0e, 0x00, 0x00 },
+	{ 0x15, 0x0e, 0x1f, 0x0e, 0x15 },
+	{ 0x00, 0x04, 0x0e, 0x04, 0x00 },
+	{ 0x00, 0x10, 0x08, 0x00, 0x00 },
+	{ 0x00, 0x04, 0x04, 0x04, 0x00 },
+	{ 0x00, 0x00, 0x10, 0x00, 0x00 },
+	{ 0x10, 0x08, 0x04, 0x02, 0x01 },
+	{ 0x0e, 0x11, 0x11, 0x0e, 0x00 },
+	{ 0x02, 0x11, 0x1f, 0x10, 0x00 },
+	{ 0x12, 0x19, 0x15, 0x12, 0x00 },
+	{ 0x0a, 0x11, 0x15, 0x0a, 0x00 },
+	{ 0x07, 0x04, 0x04, 0x1f, 0x00 },
+	{ 0x13, 0x15, 0x15, 0x09, 0x00 },
+	{ 0x0a, 0x15, 0x15, 0x09, 0x00 },
+	{ 0x11, 0x09, 0x05, 0x03, 0x00 },
+	{ 0x0a, 0x15, 0x15, 0x0a, 0x00 },
+	{ 0x02, 0x15, 0x15, 0x0e, 0x00 },
+	{ 0x00, 0x00, 0x0a, 0x00, 0x00 },
+	{ 0x00, 0x10, 0x0a, 0x00, 0x00 },
+	{ 0x00, 0x04, 0x0a, 0x11, 0x00 },
+	{ 0x00, 0x0a, 0x0a, 0x0a, 0x00 },
+	{ 0x00, 0x11, 0x0a, 0x04, 0x00 },
+	{ 0x02, 0x01, 0x15, 0x05, 0x02 },
+	{ 0x0e, 0x11, 0x17, 0x15, 0x06 },
+	{ 0x1e, 0x09, 0x09, 0x09, 0x1e },
+	{ 0x1f, 0x15, 0x15, 0x15, 0x0a },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x11 },
+	{ 0x1f, 0x11, 0x11, 0x11, 0x0e },
+	{ 0x1f, 0x15, 0x15, 0x15, 0x11 },
+	{ 0x1f, 0x05, 0x05, 0x05, 0x01 },
+	{ 0x0e, 0x11, 0x15, 0x15, 0x0c },
+	{ 0x1f, 0x04, 0x04, 0x04, 0x1f },
+	{ 0x00, 0x11, 0x1f, 0x11, 0x00 },
+	{ 0x09, 0x11, 0x11, 0x11, 0x0f },
+	{ 0x1f, 0x04, 0x04, 0x0a, 0x11 },
+	{ 0x1f, 0x10, 0x10, 0x10, 0x10 },
+	{ 0x1f, 0x02, 0x04, 0x02, 0x1f },
+	{ 0x1f, 0x02, 0x04, 0x08, 0x1f },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x0e },
+	{ 0x1f, 0x05, 0x05, 0x05, 0x02 },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x1e },
+	{ 0x1f, 0x05, 0x05, 0x0d, 0x12 },
+	{ 0x12, 0x15, 0x15, 0x15, 0x09 },
+	{ 0x01, 0x01, 0x1f, 0x01, 0x01 },
+	{ 0x0f, 0x10, 0x10, 0x10, 0x0f },
+	{ 0x07, 0x08, 0x10, 0x08, 0x07 },
+	{ 0x1f, 0x08, 0x04, 0x08, 0x1f },
+	{ 0x11, 0x0a, 0x04, 0x0a, 0x11 },
+	{ 0x01, 0x02, 0x1c, 0x02, 0x01 },
+	{ 0x11, 0x19, 0x15, 0x13, 0x11 },
+	{ 0x00, 0x00, 0x1f, 0x11, 0x00 },
+	{ 0x01, 0x02, 0x04, 0x08, 0x10 },
+	{ 0x00, 0x11, 0x1f, 0x00, 0x00 },
+	{ 0x04, 0x02, 0x01, 0x02, 0x04 },
+	{ 0x10, 0x10, 0x10, 0x10, 0x10 },
+	{ 0x00, 0x01, 0x02, 0x00, 0x00 },
+	{ 0x1e, 0x09, 0x09, 0x09, 0x1e },
+	{ 0x1f, 0x15, 0x15, 0x15, 0x0a },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x11 },
+	{ 0x1f, 0x11, 0x11, 0x11, 0x0e },
+	{ 0x1f, 0x15, 0x15, 0x15, 0x11 },
+	{ 0x1f, 0x05, 0x05, 0x05, 0x01 },
+	{ 0x0e, 0x11, 0x15, 0x15, 0x0c },
+	{ 0x1f, 0x04, 0x04, 0x04, 0x1f },
+	{ 0x00, 0x11, 0x1f, 0x11, 0x00 },
+	{ 0x09, 0x11, 0x11, 0x11, 0x0f },
+	{ 0x1f, 0x04, 0x04, 0x0a, 0x11 },
+	{ 0x1f, 0x10, 0x10, 0x10, 0x10 },
+	{ 0x1f, 0x02, 0x04, 0x02, 0x1f },
+	{ 0x1f, 0x02, 0x04, 0x08, 0x1f },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x0e },
+	{ 0x1f, 0x05, 0x05, 0x05, 0x02 },
+	{ 0x0e, 0x11, 0x11, 0x11, 0x1e },
+	{ 0x1f, 0x05, 0x05, 0x0d, 0x12 },
+	{ 0x12, 0x15, 0x15, 0x15, 0x09 },
+	{ 0x01, 0x01, 0x1f, 0x01, 0x01 },
+	{ 0x0f, 0x10, 0x10, 0x10, 0x0f },
+	{ 0x07, 0x08, 0x10, 0x08, 0x07 },
+	{ 0x1f, 0x08, 0x04, 0x08, 0x1f },
+	{ 0x11, 0x0a, 0x04, 0x0a, 0x11 },
+	{ 0x01, 0x02, 0x1c, 0x02, 0x01 },
+	{ 0x11, 0x19, 0x15, 0x13, 0x11 },
+	{ 0x00, 0x04, 0x0e, 0x11, 0x00 },
+	{ 0x00, 0x00, 0x1f, 0x00, 0x00 },
+	{ 0x00, 0x11, 0x0e, 0x04, 0x00 },
+	{ 0x04, 0x02, 0x04, 0x08, 0x04 },
+};
+
+/* dino1: 13x15, packed columns, 26 bytes */
+static const uint8_t dino1_data[26] = {
+	0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xe0, 0xfe, 0xff, 0xfd, 0x9f, 0x97, 0x17,
+	0x02, 0x01, 0x03, 0x07, 0x7f, 0x4f, 0x0f, 0x3f, 0x27, 0x03, 0x00, 0x01,
+	0x00, 0x00,
+};
+
+/* dino1: 8 pre-shifted copies of 3 pages, 312 bytes */
+static const uint8_t dino1_shifted[312] = {
+	0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xe0, 0xfe, 0xff, 0xfd, 0x9f, 0x97, 0x17,
+	0x02, 0x01, 0x03, 0x07, 0x7f, 0x4f, 0x0f, 0x3f, 0x27, 0x03, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xc0, 0x80, 0x00, 0x00, 0x80, 0xc0, 0xfc, 0xfe, 0xfa,
+	0x3e, 0x2e, 0x2e, 0x04, 0x03, 0x07, 0x0f, 0xff, 0x9f, 0x1f, 0x7f, 0x4f,
+	0x07, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x80,
+	0xf8, 0xfc, 0xf4, 0x7c, 0x5c, 0x5c, 0x08, 0x07, 0x0f, 0x1e, 0xfe, 0x3f,
+	0x3f, 0xff, 0x9f, 0x0f, 0x02, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xf0, 0xf8, 0xe8, 0xf8, 0xb8, 0xb8, 0x10, 0x0f, 0x1e,
+	0x3c, 0xfc, 0x7e, 0x7f, 0xff, 0x3f, 0x1f, 0x04, 0x0c, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x03, 0x02, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xf0, 0xd0, 0xf0, 0x70, 0x70,
+	0x20, 0x1e, 0x3c, 0x78, 0xf8, 0xfc, 0xfe, 0xff, 0x7f, 0x3f, 0x09, 0x19,
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x07, 0x04, 0x00, 0x03, 0x02, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xa0,
+	0xe0, 0xe0, 0xe0, 0x40, 0x3c, 0x78, 0xf0, 0xf0, 0xf8, 0xfc, 0xff, 0xff,
+	0x7f, 0x13, 0x32, 0x02, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x09, 0x01, 0x07,
+	0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0xc0, 0x40, 0xc0, 0xc0, 0xc0, 0x80, 0x78, 0xf0, 0xe0, 0xe0, 0xf0,
+	0xf8, 0xff, 0xff, 0xff, 0x27, 0x65, 0x05, 0x00, 0x00, 0x00, 0x01, 0x1f,
+	0x13, 0x03, 0x0f, 0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0xf0, 0xe0,
+	0xc0, 0xc0, 0xe0, 0xf0, 0xff, 0xff, 0xfe, 0x4f, 0xcb, 0x0b, 0x01, 0x00,
+	0x01, 0x03, 0x3f, 0x27, 0x07, 0x1f, 0x13, 0x01, 0x00, 0x00, 0x00, 0x00,
+};
+
+/* dino1: collision mask, one word per column */
+static const uint32_t dino1_mask[13] = {
+	0x000001e0u, 0x000003c0u, 0x00000780u, 0x00007f80u, 0x00004fc0u, 0x00000fe0u,
+	0x00003ffeu, 0x000027ffu, 0x000003fdu, 0x0000009fu, 0x00000197u, 0x00000017u,
+	0x00000002u,
+};
+
+const Sprite dino1 = {
+	.width = DINO1_WIDTH,
+	.height = DINO1_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = dino1_data,
+	.shifted = dino1_shifted,
+	.mask = dino1_mask,
+};
+
+/* dino2: 13x15, packed columns, 26 bytes */
+static const uint8_t dino2_data[26] = {
+	0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xe0, 0xfe, 0xff, 0xfd, 0x9f, 0x97, 0x17,
+	0x02, 0x01, 0x03, 0x07, 0x3f, 0x2f, 0x0f, 0x7f, 0x47, 0x03, 0x00, 0x01,
+	0x00, 0x00,
+};
+
+/* dino2: 8 pre-shifted copies of 3 pages, 312 bytes */
+static const uint8_t dino2_shifted[312] = {
+	0xe0, 0xc0, 0x80, 0x80, 0xc0, 0xe0, 0xfe, 0xff, 0xfd, 0x9f, 0x97, 0x17,
+	0x02, 0x01, 0x03, 0x07, 0x3f, 0x2f, 0x0f, 0x7f, 0x47, 0x03, 0x00, 0x01,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xc0, 0x80, 0x00, 0x00, 0x80, 0xc0, 0xfc, 0xfe, 0xfa,
+	0x3e, 0x2e, 0x2e, 0x04, 0x03, 0x07, 0x0f, 0x7f, 0x5f, 0x1f, 0xff, 0x8f,
+	0x07, 0x01, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x80,
+	0xf8, 0xfc, 0xf4, 0x7c, 0x5c, 0x5c, 0x08, 0x07, 0x0f, 0x1e, 0xfe, 0xbf,
+	0x3f, 0xff, 0x1f, 0x0f, 0x02, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0xf0, 0xf8, 0xe8, 0xf8, 0xb8, 0xb8, 0x10, 0x0f, 0x1e,
+	0x3c, 0xfc, 0x7e, 0x7f, 0xff, 0x3f, 0x1f, 0x04, 0x0c, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x01, 0x01, 0x00, 0x03, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0xf0, 0xd0, 0xf0, 0x70, 0x70,
+	0x20, 0x1e, 0x3c, 0x78, 0xf8, 0xfc, 0xfe, 0xff, 0x7f, 0x3f, 0x09, 0x19,
+	0x01, 0x00, 0x00, 0x00, 0x00, 0x03, 0x02, 0x00, 0x07, 0x04, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xe0, 0xa0,
+	0xe0, 0xe0, 0xe0, 0x40, 0x3c, 0x78, 0xf0, 0xf0, 0xf8, 0xfc, 0xff, 0xff,
+	0x7f, 0x13, 0x32, 0x02, 0x00, 0x00, 0x00, 0x00, 0x07, 0x05, 0x01, 0x0f,
+	0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x80, 0xc0, 0x40, 0xc0, 0xc0, 0xc0, 0x80, 0x78, 0xf0, 0xe0, 0xe0, 0xf0,
+	0xf8, 0xff, 0xff, 0xff, 0x27, 0x65, 0x05, 0x00, 0x00, 0x00, 0x01, 0x0f,
+	0x0b, 0x03, 0x1f, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0xf0, 0xe0,
+	0xc0, 0xc0, 0xe0, 0xf0, 0xff, 0xff, 0xfe, 0x4f, 0xcb, 0x0b, 0x01, 0x00,
+	0x01, 0x03, 0x1f, 0x17, 0x07, 0x3f, 0x23, 0x01, 0x00, 0x00, 0x00, 0x00,
+};
+
+/* dino2: collision mask, one word per column */
+static const uint32_t dino2_mask[13] = {
+	0x000001e0u, 0x000003c0u, 0x00000780u, 0x00003f80u, 0x00002fc0u, 0x00000fe0u,
+	0x00007ffeu, 0x000047ffu, 0x000003fdu, 0x0000009fu, 0x00000197u, 0x00000017u,
+	0x00000002u,
+};
+
+const Sprite dino2 = {
+	.width = DINO2_WIDTH,
+	.height = DINO2_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = dino2_data,
+	.shifted = dino2_shifted,
+	.mask = dino2_mask,
+};
+
+/* dino_ducking1: 20x10, packed columns, 40 bytes */
+static const uint8_t dino_ducking1_data[40] = {
+	0x07, 0x0e, 0x1e, 0xbc, 0x7c, 0x3e, 0xfe, 0x7e, 0x7e, 0x3e, 0xfe, 0xbc,
+	0x1c, 0x1e, 0x3f, 0x3d, 0x3f, 0x27, 0x27, 0x02, 0x00, 0x00, 0x00, 0x03,
+	0x02, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+};
+
+/* dino_ducking1: compiled blit, assumes the sprite is completely on screen */
+static void dino_ducking1_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0x07u << s;
+	p[1] |= 0x0eu << s;
+	p[2] |= 0x1eu << s;
+	p[3] |= 0xbcu << s;
+	p[4] |= 0x7cu << s;
+	p[5] |= 0x3eu << s;
+	p[6] |= 0xfeu << s;
+	p[7] |= 0x7eu << s;
+	p[8] |= 0x7eu << s;
+	p[9] |= 0x3eu << s;
+	p[10] |= 0xfeu << s;
+	p[11] |= 0xbcu << s;
+	p[12] |= 0x1cu << s;
+	p[13] |= 0x1eu << s;
+	p[14] |= 0x3fu << s;
+	p[15] |= 0x3du << s;
+	p[16] |= 0x3fu << s;
+	p[17] |= 0x27u << s;
+	p[18] |= 0x27u << s;
+	p[19] |= 0x02u << s;
+	p[128] |= (0x0006u << s) >> 8;
+	p[129] |= (0x000eu << s) >> 8;
+	p[130] |= (0x001eu << s) >> 8;
+	p[131] |= (0x03bcu << s) >> 8;
+	p[132] |= (0x027cu << s) >> 8;
+	p[133] |= (0x003eu << s) >> 8;
+	p[134] |= (0x01feu << s) >> 8;
+	p[135] |= (0x017eu << s) >> 8;
+	p[136] |= (0x007eu << s) >> 8;
+	p[137] |= (0x003eu << s) >> 8;
+	p[138] |= (0x00feu << s) >> 8;
+	p[139] |= (0x00bcu << s) >> 8;
+	p[140] |= (0x001cu << s) >> 8;
+	p[141] |= (0x001eu << s) >> 8;
+	p[142] |= (0x003eu << s) >> 8;
+	p[143] |= (0x003cu << s) >> 8;
+	p[144] |= (0x003eu << s) >> 8;
+	p[145] |= (0x0026u << s) >> 8;
+	p[146] |= (0x0026u << s) >> 8;
+	p[147] |= (0x0002u << s) >> 8;
+
+	if(s > 6) {
+		p[259] |= (0x0200u << s) >> 16;
+		p[260] |= (0x0200u << s) >> 16;
+	}
+}
+
+/* dino_ducking1: collision mask, one word per column */
+static const uint32_t dino_ducking1_mask[20] = {
+	0x00000007u, 0x0000000eu, 0x0000001eu, 0x000003bcu, 0x0000027cu, 0x0000003eu,
+	0x000001feu, 0x0000017eu, 0x0000007eu, 0x0000003eu, 0x000000feu, 0x000000bcu,
+	0x0000001cu, 0x0000001eu, 0x0000003fu, 0x0000003du, 0x0000003fu, 0x00000027u,
+	0x00000027u, 0x00000002u,
 };
+
+const Sprite dino_ducking1 = {
+	.width = DINO_DUCKING1_WIDTH,
+	.height = DINO_DUCKING1_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = dino_ducking1_data,
+	.blit = dino_ducking1_blit,
+	.mask = dino_ducking1_mask,
+};
+
+/* dino_ducking2: 20x10, packed columns, 40 bytes */
+static const uint8_t dino_ducking2_data[40] = {
+	0x07, 0x0e, 0x1e, 0xbc, 0x7c, 0x3e, 0xfe, 0x7e, 0x7e, 0x3e, 0xfe, 0xbc,
+	0x1c, 0x1e, 0x3f, 0x3d, 0x3f, 0x27, 0x27, 0x02, 0x00, 0x00, 0x00, 0x01,
+	0x01, 0x00, 0x03, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00,
+};
+
+/* dino_ducking2: compiled blit, assumes the sprite is completely on screen */
+static void dino_ducking2_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0x07u << s;
+	p[1] |= 0x0eu << s;
+	p[2] |= 0x1eu << s;
+	p[3] |= 0xbcu << s;
+	p[4] |= 0x7cu << s;
+	p[5] |= 0x3eu << s;
+	p[6] |= 0xfeu << s;
+	p[7] |= 0x7eu << s;
+	p[8] |= 0x7eu << s;
+	p[9] |= 0x3eu << s;
+	p[10] |= 0xfeu << s;
+	p[11] |= 0xbcu << s;
+	p[12] |= 0x1cu << s;
+	p[13] |= 0x1eu << s;
+	p[14] |= 0x3fu << s;
+	p[15] |= 0x3du << s;
+	p[16] |= 0x3fu << s;
+	p[17] |= 0x27u << s;
+	p[18] |= 0x27u << s;
+	p[19] |= 0x02u << s;
+	p[128] |= (0x0006u << s) >> 8;
+	p[129] |= (0x000eu << s) >> 8;
+	p[130] |= (0x001eu << s) >> 8;
+	p[131] |= (0x01bcu << s) >> 8;
+	p[132] |= (0x017cu << s) >> 8;
+	p[133] |= (0x003eu << s) >> 8;
+	p[134] |= (0x03feu << s) >> 8;
+	p[135] |= (0x027eu << s) >> 8;
+	p[136] |= (0x007eu << s) >> 8;
+	p[137] |= (0x003eu << s) >> 8;
+	p[138] |= (0x00feu << s) >> 8;
+	p[139] |= (0x00bcu << s) >> 8;
+	p[140] |= (0x001cu << s) >> 8;
+	p[141] |= (0x001eu << s) >> 8;
+	p[142] |= (0x003eu << s) >> 8;
+	p[143] |= (0x003cu << s) >> 8;
+	p[144] |= (0x003eu << s) >> 8;
+	p[145] |= (0x0026u << s) >> 8;
+	p[146] |= (0x0026u << s) >> 8;
+	p[147] |= (0x0002u << s) >> 8;
+
+	if(s > 6) {
+		p[262] |= (0x0200u << s) >> 16;
+		p[263] |= (0x0200u << s) >> 16;
+	}
+}
+
+/* dino_ducking2: collision mask, one word per column */
+static const uint32_t dino_ducking2_mask[20] = {
+	0x00000007u, 0x0000000eu, 0x0000001eu, 0x000001bcu, 0x0000017cu, 0x0000003eu,
+	0x000003feu, 0x0000027eu, 0x0000007eu, 0x0000003eu, 0x000000feu, 0x000000bcu,
+	0x0000001cu, 0x0000001eu, 0x0000003fu, 0x0000003du, 0x0000003fu, 0x00000027u,
+	0x00000027u, 0x00000002u,
+};
+
+const Sprite dino_ducking2 = {
+	.width = DINO_DUCKING2_WIDTH,
+	.height = DINO_DUCKING2_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = dino_ducking2_data,
+	.blit = dino_ducking2_blit,
+	.mask = dino_ducking2_mask,
+};
+
+/* cactus_small: 6x11, packed columns, 12 bytes */
+static const uint8_t cactus_small_data[12] = {
+	0x78, 0x40, 0xff, 0xff, 0x10, 0x1e, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00,
+};
+
+/* cactus_small: compiled blit, assumes the sprite is completely on screen */
+static void cactus_small_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0x78u << s;
+	p[1] |= 0x40u << s;
+	p[2] |= 0xffu << s;
+	p[3] |= 0xffu << s;
+	p[4] |= 0x10u << s;
+	p[5] |= 0x1eu << s;
+	p[128] |= (0x0078u << s) >> 8;
+	p[129] |= (0x0040u << s) >> 8;
+	p[130] |= (0x07feu << s) >> 8;
+	p[131] |= (0x07feu << s) >> 8;
+	p[132] |= (0x0010u << s) >> 8;
+	p[133] |= (0x001eu << s) >> 8;
+
+	if(s > 5) {
+		p[258] |= (0x0600u << s) >> 16;
+		p[259] |= (0x0600u << s) >> 16;
+	}
+}
+
+/* cactus_small: collision mask, one word per column */
+static const uint32_t cactus_small_mask[6] = {
+	0x00000078u, 0x00000040u, 0x000007ffu, 0x000007ffu, 0x00000010u, 0x0000001eu,
+};
+
+const Sprite cactus_small = {
+	.width = CACTUS_SMALL_WIDTH,
+	.height = CACTUS_SMALL_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = cactus_small_data,
+	.blit = cactus_small_blit,
+	.mask = cactus_small_mask,
+};
+
+/* cactus_big: 8x14, packed columns, 16 bytes */
+static const uint8_t cactus_big_data[16] = {
+	0xf8, 0xf8, 0x80, 0xff, 0xff, 0x80, 0xf8, 0xf8, 0x00, 0x01, 0x01, 0x3f,
+	0x3f, 0x01, 0x01, 0x00,
+};
+
+/* cactus_big: compiled blit, assumes the sprite is completely on screen */
+static void cactus_big_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0xf8u << s;
+	p[1] |= 0xf8u << s;
+	p[2] |= 0x80u << s;
+	p[3] |= 0xffu << s;
+	p[4] |= 0xffu << s;
+	p[5] |= 0x80u << s;
+	p[6] |= 0xf8u << s;
+	p[7] |= 0xf8u << s;
+	p[128] |= (0x00f8u << s) >> 8;
+	p[129] |= (0x01f8u << s) >> 8;
+	p[130] |= (0x0180u << s) >> 8;
+	p[131] |= (0x3ffeu << s) >> 8;
+	p[132] |= (0x3ffeu << s) >> 8;
+	p[133] |= (0x0180u << s) >> 8;
+	p[134] |= (0x01f8u << s) >> 8;
+	p[135] |= (0x00f8u << s) >> 8;
+
+	if(s > 2) {
+		p[259] |= (0x3e00u << s) >> 16;
+		p[260] |= (0x3e00u << s) >> 16;
+	}
+}
+
+/* cactus_big: collision mask, one word per column */
+static const uint32_t cactus_big_mask[8] = {
+	0x000000f8u, 0x000001f8u, 0x00000180u, 0x00003fffu, 0x00003fffu, 0x00000180u,
+	0x000001f8u, 0x000000f8u,
+};
+
+const Sprite cactus_big = {
+	.width = CACTUS_BIG_WIDTH,
+	.height = CACTUS_BIG_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = cactus_big_data,
+	.blit = cactus_big_blit,
+	.mask = cactus_big_mask,
+};
+
+/* bird1: 12x6, packed columns, 12 bytes */
+static const uint8_t bird1_data[12] = {
+	0x10, 0x18, 0x14, 0x1c, 0x38, 0x30, 0x3f, 0x3e, 0x3c, 0x38, 0x30, 0x20,
+};
+
+/* bird1: compiled blit, assumes the sprite is completely on screen */
+static void bird1_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0x10u << s;
+	p[1] |= 0x18u << s;
+	p[2] |= 0x14u << s;
+	p[3] |= 0x1cu << s;
+	p[4] |= 0x38u << s;
+	p[5] |= 0x30u << s;
+	p[6] |= 0x3fu << s;
+	p[7] |= 0x3eu << s;
+	p[8] |= 0x3cu << s;
+	p[9] |= 0x38u << s;
+	p[10] |= 0x30u << s;
+	p[11] |= 0x20u << s;
+
+	if(s > 2) {
+		p[128] |= (0x0010u << s) >> 8;
+		p[129] |= (0x0018u << s) >> 8;
+		p[130] |= (0x0014u << s) >> 8;
+		p[131] |= (0x001cu << s) >> 8;
+		p[132] |= (0x0038u << s) >> 8;
+		p[133] |= (0x0030u << s) >> 8;
+		p[134] |= (0x003eu << s) >> 8;
+		p[135] |= (0x003eu << s) >> 8;
+		p[136] |= (0x003cu << s) >> 8;
+		p[137] |= (0x0038u << s) >> 8;
+		p[138] |= (0x0030u << s) >> 8;
+		p[139] |= (0x0020u << s) >> 8;
+	}
+}
+
+/* bird1: collision mask, one word per column */
+static const uint32_t bird1_mask[12] = {
+	0x00000010u, 0x00000018u, 0x00000014u, 0x0000001cu, 0x00000038u, 0x00000030u,
+	0x0000003fu, 0x0000003eu, 0x0000003cu, 0x00000038u, 0x00000030u, 0x00000020u,
+};
+
+const Sprite bird1 = {
+	.width = BIRD1_WIDTH,
+	.height = BIRD1_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = bird1_data,
+	.blit = bird1_blit,
+	.mask = bird1_mask,
+};
+
+/* bird2: 12x6, packed columns, 12 bytes */
+static const uint8_t bird2_data[12] = {
+	0x10, 0x18, 0x14, 0x1c, 0x38, 0x30, 0x38, 0x38, 0x38, 0x38, 0x30, 0x20,
+};
+
+/* bird2: compiled blit, assumes the sprite is completely on screen */
+static void bird2_blit(int x, int y) {
+	uint8_t *p = &pixel_data[y >> 3][x];
+	int s = y & 7;
+
+	p[0] |= 0x10u << s;
+	p[1] |= 0x18u << s;
+	p[2] |= 0x14u << s;
+	p[3] |= 0x1cu << s;
+	p[4] |= 0x38u << s;
+	p[5] |= 0x30u << s;
+	p[6] |= 0x38u << s;
+	p[7] |= 0x38u << s;
+	p[8] |= 0x38u << s;
+	p[9] |= 0x38u << s;
+	p[10] |= 0x30u << s;
+	p[11] |= 0x20u << s;
+
+	if(s > 2) {
+		p[128] |= (0x0010u << s) >> 8;
+		p[129] |= (0x0018u << s) >> 8;
+		p[130] |= (0x0014u << s) >> 8;
+		p[131] |= (0x001cu << s) >> 8;
+		p[132] |= (0x0038u << s) >> 8;
+		p[133] |= (0x0030u << s) >> 8;
+		p[134] |= (0x0038u << s) >> 8;
+		p[135] |= (0x0038u << s) >> 8;
+		p[136] |= (0x0038u << s) >> 8;
+		p[137] |= (0x0038u << s) >> 8;
+		p[138] |= (0x0030u << s) >> 8;
+		p[139] |= (0x0020u << s) >> 8;
+	}
+}
+
+/* bird2: collision mask, one word per column */
+static const uint32_t bird2_mask[12] = {
+	0x00000010u, 0x00000018u, 0x00000014u, 0x0000001cu, 0x00000038u, 0x00000030u,
+	0x00000038u, 0x00000038u, 0x00000038u, 0x00000038u, 0x00000030u, 0x00000020u,
+};
+
+const Sprite bird2 = {
+	.width = BIRD2_WIDTH,
+	.height = BIRD2_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = bird2_data,
+	.blit = bird2_blit,
+	.mask = bird2_mask,
+};
+
+/* dino_run: 2 frames, changed column spans for the step into each frame */
+static const Sprite *const dino_run_frames[2] = { &dino1, &dino2 };
+
+static const uint8_t dino_run_spans[6] = {
+	1, 3, 5, // into dino1
+	1, 3, 5, // into dino2
+};
+
+static const uint8_t dino_run_span_offsets[2] = { 0, 3 };
+
+const Animation dino_run = {
+	.frame_count = 2,
+	.frames = dino_run_frames,
+	.spans = dino_run_spans,
+	.span_offsets = dino_run_span_offsets,
+};
+
+/* dino_duck: 2 frames, changed column spans for the step into each frame */
+static const Sprite *const dino_duck_frames[2] = { &dino_ducking1, &dino_ducking2 };
+
+static const uint8_t dino_duck_spans[6] = {
+	1, 3, 5, // into dino_ducking1
+	1, 3, 5, // into dino_ducking2
+};
+
+static const uint8_t dino_duck_span_offsets[2] = { 0, 3 };
+
+const Animation dino_duck = {
+	.frame_count = 2,
+	.frames = dino_duck_frames,
+	.spans = dino_duck_spans,
+	.span_offsets = dino_duck_span_offsets,
+};
+
+/* bird_flap: 2 frames, changed column spans for the step into each frame */
+static const Sprite *const bird_flap_frames[2] = { &bird1, &bird2 };
+
+static const uint8_t bird_flap_spans[6] = {
+	1, 6, 3, // into bird1
+	1, 6, 3, // into bird2
+};
+
+static const uint8_t bird_flap_span_offsets[2] = { 0, 3 };
+
+const Animation bird_flap = {
+	.frame_count = 2,
+	.frames = bird_flap_frames,
+	.spans = bird_flap_spans,
+	.span_offsets = bird_flap_span_offsets,
+};
+
+/* arrow_up: 5x5, packed columns, 5 bytes */
+static const uint8_t arrow_up_data[5] = {
+	0x04, 0x06, 0x1f, 0x06, 0x04,
+};
+
+const Sprite arrow_up = {
+	.width = ARROW_UP_WIDTH,
+	.height = ARROW_UP_HEIGHT,
+	.encoding = SPRITE_PACKED,
+	.data = arrow_up_data,
+};
+
+/* title: 128x32, run-length encoded columns, 398 bytes */
+static const uint8_t title_data[398] = {
+	0x04, 0x0a, 0xfe, 0xfe, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0xf8, 0xf8,
+	0x03, 0x06, 0x06, 0x06, 0xfe, 0xfe, 0x06, 0x06, 0x03, 0x15, 0xfe, 0xfe,
+	0x18, 0x18, 0x60, 0x60, 0x80, 0x80, 0xfe, 0xfe, 0x00, 0xf8, 0xf8, 0x06,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0xf8, 0xf8, 0x0c, 0x0d, 0xfe, 0xfe, 0x66,
+	0x66, 0x66, 0x66, 0xe6, 0xe6, 0x18, 0x18, 0x00, 0xfe, 0xfe, 0x06, 0x2e,
+	0xfe, 0xfe, 0x00, 0xfe, 0xfe, 0x18, 0x18, 0x60, 0x60, 0x80, 0x80, 0xfe,
+	0xfe, 0x00, 0xfe, 0xfe, 0x18, 0x18, 0x60, 0x60, 0x80, 0x80, 0xfe, 0xfe,
+	0x00, 0xfe, 0xfe, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x06, 0x06, 0x00,
+	0xfe, 0xfe, 0x66, 0x66, 0x66, 0x66, 0xe6, 0xe6, 0x18, 0x18, 0x04, 0x00,
+	0x04, 0x0a, 0x07, 0x07, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x01, 0x01,
+	0x03, 0x06, 0x06, 0x06, 0x07, 0x07, 0x06, 0x06, 0x03, 0x02, 0x07, 0x07,
+	0x04, 0x0f, 0x01, 0x01, 0x07, 0x07, 0x00, 0x01, 0x01, 0x06, 0x06, 0x06,
+	0x06, 0x06, 0x06, 0x01, 0x01, 0x0b, 0x03, 0x80, 0x07, 0x07, 0x04, 0x12,
+	0x01, 0x01, 0x06, 0x06, 0x00, 0x01, 0x01, 0x06, 0x06, 0x06, 0x06, 0x06,
+	0x06, 0x01, 0x01, 0x00, 0x07, 0x07, 0x04, 0x07, 0x01, 0x01, 0x07, 0x07,
+	0x00, 0x07, 0x07, 0x04, 0x12, 0x01, 0x01, 0x07, 0x07, 0x00, 0x07, 0x07,
+	0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00, 0x07, 0x07, 0x04,
+	0x04, 0x01, 0x01, 0x06, 0x06, 0x04, 0x00, 0x0e, 0x0d, 0xe0, 0xc0, 0x80,
+	0x80, 0xc0, 0xe0, 0xfe, 0xff, 0xfd, 0x9f, 0x97, 0x17, 0x02, 0x19, 0x0c,
+	0x08, 0x0c, 0x0a, 0x0e, 0x1c, 0x18, 0x1f, 0x1f, 0x1e, 0x1c, 0x18, 0x10,
+	0x0e, 0x10, 0x80, 0x00, 0xf0, 0xf0, 0x00, 0xe0, 0x00, 0x00, 0xf0, 0xf0,
+	0x00, 0xfe, 0xfe, 0x00, 0xf0, 0xf0, 0x12, 0x06, 0x80, 0x00, 0xf0, 0xf0,
+	0x00, 0xe0, 0x0a, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x81, 0x83, 0x87, 0xff,
+	0xcf, 0x8f, 0xbf, 0xa7, 0x83, 0x80, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0xc0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0xc0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x87, 0x84, 0xff, 0xff, 0x81, 0x81, 0x80, 0x80, 0x81, 0x83, 0x83, 0xff,
+	0xff, 0x83, 0x83, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xc0, 0x80, 0x87, 0x84,
+	0xff, 0xff, 0x81, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80,
+};
+
+const Sprite title = {
+	.width = TITLE_WIDTH,
+	.height = TITLE_HEIGHT,
+	.encoding = SPRITE_RLE,
+	.data = title_data,
+};
+
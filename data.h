@@ -0,0 +1,68 @@
+/**
+ * @file data.h
+ * @brief Declarations and dimensions of the graphics in data.c.
+ *
+ * Generated by tools/assetgen from assets/assets.txt.
+ * Do not edit by hand: edit the images in assets/ and run make.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#ifndef DATA_H
+#define DATA_H
+
+#define FONT_WIDTH 5
+#define FONT_HEIGHT 5
+#define FONT_GLYPHS 95
+extern const uint8_t font[FONT_GLYPHS][FONT_WIDTH];
+
+#define DINO1_WIDTH 13
+#define DINO1_HEIGHT 15
+extern const Sprite dino1;
+
+#define DINO2_WIDTH 13
+#define DINO2_HEIGHT 15
+extern const Sprite dino2;
+
+#define DINO_DUCKING1_WIDTH 20
+#define DINO_DUCKING1_HEIGHT 10
+extern const Sprite dino_ducking1;
+
+#define DINO_DUCKING2_WIDTH 20
+#define DINO_DUCKING2_HEIGHT 10
+extern const Sprite dino_ducking2;
+
+#define CACTUS_SMALL_WIDTH 6
+#define CACTUS_SMALL_HEIGHT 11
+extern const Sprite cactus_small;
+
+#define CACTUS_BIG_WIDTH 8
+#define CACTUS_BIG_HEIGHT 14
+extern const Sprite cactus_big;
+
+#define BIRD1_WIDTH 12
+#define BIRD1_HEIGHT 6
+extern const Sprite bird1;
+
+#define BIRD2_WIDTH 12
+#define BIRD2_HEIGHT 6
+extern const Sprite bird2;
+
+extern const Animation dino_run;
+
+extern const Animation dino_duck;
+
+extern const Animation bird_flap;
+
+#define ARROW_UP_WIDTH 5
+#define ARROW_UP_HEIGHT 5
+extern const Sprite arrow_up;
+
+#define TITLE_WIDTH 128
+#define TITLE_HEIGHT 32
+extern const Sprite title;
+
+#endif
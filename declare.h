@@ -2,7 +2,7 @@
  * @file declare.h
  * @brief Header file containing declarations for various functions, arrays, and variables used in the game.
  *
- * This file declares display-related functions, arrays for letters, dino characters, cacti, birds, numbers, and arrow_up.
+ * This file declares display-related functions, the font and arrays for dino characters, cacti, birds, and arrow_up.
  * It also defines game states and character actions, as well as global variables for the game.
  * Additionally, it declares functions for changing game state and defines constants for leaderboard entries and initials length.
  *
@@ -19,39 +19,108 @@
 /* Declare display-related functions from mipslabfunc.c */
 void display_init(void);
 uint8_t spi_send_recv(uint8_t data);
+void display_objects(void);
 
 /*------------------------------------------------------------------*/
 /* Code by Elias Hollstrand and Matƒtias Kvist */
 
-// Declare an array of letters
-extern const uint8_t const letters[28][25];
+// Declare functions for drawing into the frame buffer
+void clear_all_pixels(void);
+void fill_rectangle(int x0, int y0, int w, int h);
+void draw_number(int x, int y, int n);
 
-// Declare an array containing dino character
-extern const uint8_t const dino1[195];
-extern const uint8_t const dino2[195];
-extern const uint8_t const dino_ducking1[200];
-extern const uint8_t const dino_ducking2[200];
+// Declare functions for pre-rendered layers
+void store_layer(uint8_t layer[4][128]);
+void load_layer(const uint8_t layer[4][128]);
+void draw_bcd(uint8_t layer[4][128], int x, int y, uint32_t bcd, uint32_t previous);
 
-// Declare arrays containing cactae
-extern const uint8_t const cactus_small[66];
-extern const uint8_t const cactus_big[112];
+// Declare text drawing functions
+void draw_columns(int x, int y, const uint8_t *columns, int count);
+const uint8_t *font_glyph(char c);
+void draw_char(int x, int y, char c);
+void draw_string(int x, int y, char* s);
+void draw_hex(int x, int y, uint32_t value, int digits);
+void substring(char source[], char dest[], int start, int length);
 
-// Declare array containing bird
-extern const uint8_t const bird1[72];
-extern const uint8_t const bird2[72];
+// Declare the range of characters covered by the font in data.c
+#define FONT_FIRST_CHAR ' '
+#define FONT_LAST_CHAR '~'
+#define DIGIT_WIDTH 4
 
-// Declare an array of numbers
-extern const uint8_t const numbers[10][20];
+// Declare sprite encodings
+typedef enum {
+    SPRITE_PACKED, // Pages of 8 rows, one byte per column, bit 0 at the top
+    SPRITE_RLE     // Packed columns as (skip, count, bytes...) records per page
+} SpriteEncoding;
+
+// Declare the sprite descriptor emitted by tools/assetgen
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t encoding;
+    const uint8_t *data;
+    void (*blit)(int x, int y); // Compiled blit function, or 0 if the sprite has none
+    const uint8_t *shifted;     // 8 copies moved down by 0-7 rows, or 0 if the sprite has none
+    const uint32_t *mask;       // Collision mask, one word per column with bit y being row y, or 0
+} Sprite;
+
+// Declare the animation descriptor emitted by tools/assetgen
+typedef struct {
+    uint8_t frame_count;
+    const Sprite *const *frames;
+    const uint8_t *spans;        // For each frame: span count, then (first column, columns) pairs
+    const uint8_t *span_offsets; // Where the spans for the step into each frame start
+} Animation;
+
+// Declare the clip rectangle that drawing is limited to, columns [x0, x1) and rows [y0, y1)
+typedef struct {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} ClipRect;
+
+extern ClipRect clip_rect;
+
+// Declare functions for clipping and the clipped blitter
+void set_clip(int x, int y, int width, int height);
+void reset_clip(void);
+void blit_packed(int x, int y, const uint8_t *data, int stride, int width, int height);
+
+// Declare the number of pages in each pre-shifted copy of a sprite
+#define PRESHIFT_PAGES(height) (((height) + 14) >> 3)
+
+// Declare the pixel data that the compiled sprites draw into
+extern uint8_t pixel_data[4][128];
 
-// Declare an array containing arrow_up
-extern const uint8_t const arrow_up [5][5];
+// Declare the generated graphics: font, dino characters, cactae, birds and arrow_up
+#include "data.h"
+
+// Declare image drawing functions
+void draw_image(int x, int y, const Sprite *sprite);
+void draw_preshifted(int x, int y, const Sprite *sprite);
+void draw_rle(int x, int y, const Sprite *sprite);
+void draw_image_columns(int x, int y, const Sprite *sprite, int first, int count);
+void draw_dithered(int x, int y, const Sprite *sprite);
+void draw_animation_step(const uint8_t layer[4][128], int x, int y, const Animation *animation, int frame);
+
+// Declare functions for dirty-region tracking, and the columns of each page that changed
+extern uint8_t dirty_start[4];
+extern uint8_t dirty_end[4];
+
+void mark_dirty(int x, int y, int width, int height);
+void mark_all_dirty(void);
+void restore_rect(const uint8_t layer[4][128], int x, int y, int width, int height);
 
 // Declare gamestates for the game
 typedef enum {
     MENU_STATE,
     GAME_STATE,
     GAME_OVER_STATE,
-    ENTER_NAME_STATE
+    ENTER_NAME_STATE,
+    REPLAY_STATE,
+    REWIND_STATE,
+    ATTRACT_STATE
 } GameState;
 
 // Declare character actions for the game
@@ -62,13 +131,280 @@ typedef enum {
 
 // Declare global variables for the game
 extern int highscore;
-extern int score;
 
 extern int menu_page;
 
 // Declare function to change gamestate
 void change_state(GameState newState);
 
+// Declare functions that draw the screens of the menu, game over and name entry states
+void draw_menu(void);
+void draw_gameover(void);
+void draw_enter_name(void);
+
+// Declare the pixel-exact collision tests between two sprites, standing still and moving
+int sprites_collide(int ax, int ay, const Sprite *a, int bx, int by, const Sprite *b);
+int sprites_collide_swept(int ax, int ay, int dy, const Sprite *a, int bx, int by, int dx, const Sprite *b);
+
+// Declare the random number generator (PCG32) and its streams
+typedef struct {
+    uint64_t state;
+    uint64_t increment; // Selects the stream, always odd
+} Rng;
+
+#define RNG_SPAWN_STREAM 1
+#define RNG_AUTOPILOT_STREAM 2
+
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream);
+uint32_t rng_next(Rng *rng);
+uint32_t rng_below(Rng *rng, uint32_t bound);
+
+// Declare alias tables, for drawing from a weighted distribution in constant time
+#define MAX_ALIAS_ENTRIES 8
+
+typedef struct {
+    uint8_t count;
+    uint8_t alias[MAX_ALIAS_ENTRIES];      // Entry taken instead when the coin toss fails
+    uint32_t threshold[MAX_ALIAS_ENTRIES]; // Chance of keeping the entry itself, out of 65536
+} AliasTable;
+
+int build_alias_table(AliasTable *table, const uint8_t *weights, int count);
+int alias_sample(const AliasTable *table, Rng *rng);
+
+// Declare the obstacle archetypes that spawn_obstacle() picks from
+#define DIFFICULTY_LEVELS 4
+
+typedef struct {
+    const Sprite *sprite;               // Sprite at spawn, its collision mask is the hitbox
+    const Animation *animation;         // Frames to cycle through, or 0 if the obstacle is not animated
+    uint8_t animation_period;           // Ticks per animation frame
+    uint8_t bottom;                     // Row just below the obstacle, i.e. its spawn height
+    uint16_t velocity;                  // Speed relative to the ground, 256 = moves with the ground
+    uint8_t weights[DIFFICULTY_LEVELS]; // Relative chance of spawning at each difficulty level
+} ObstacleArchetype;
+
+// Declare the precomputed jump trajectories: a tapped jump and a jump held as long as it extends
+#define JUMP_TAPPED 0
+#define JUMP_HELD 1
+#define NUM_JUMP_ARCS 2
+#define MAX_JUMP_TICKS 48
+
+typedef struct {
+    uint8_t ticks;                // Ticks from takeoff until the dino is back on the ground
+    uint8_t rise[MAX_JUMP_TICKS]; // Pixels the dino is above the ground after each tick
+} JumpArc;
+
+// Declare how an obstacle archetype can be cleared, worked out from the jump arcs
+typedef struct {
+    uint8_t duck;                    // 1 if the obstacle passes over the ducking dino
+    uint8_t lead[NUM_JUMP_ARCS];     // Ticks from takeoff until the dino is above the obstacle
+    uint8_t airtime[NUM_JUMP_ARCS];  // Ticks the dino then stays above it, 0 if it never gets there
+} ObstacleClearance;
+
+int can_jump(int32_t y_q8, int velocity);
+void apply_gravity(int32_t *y_q8, int *velocity, int32_t ground_q8, int gravity);
+int clearing_jump(const ObstacleClearance *clearance, int width, int speed);
+
+// Declare a band of the difficulty schedule, which holds from min_score until the next band
+typedef struct {
+    uint16_t min_score; // First score of the band
+    uint16_t speed;     // Scroll speed in 1/256 pixels per tick
+    uint8_t min_gap;    // Least extra empty ground before an obstacle, in pixels
+    uint8_t max_gap;    // Most extra empty ground before an obstacle, in pixels
+    uint8_t level;      // Difficulty level whose archetype weights are used
+} DifficultyBand;
+
+// Declare the rules a game is played by: the physics, the obstacles and the difficulty schedule,
+// with the tables that build_game_rules() works out from them
+#define MAX_ARCHETYPES MAX_ALIAS_ENTRIES
+
+typedef struct {
+    int jump_velocity;                  // In 1/256 pixels per tick, negative is up
+    int gravity;                        // In 1/256 pixels per tick per tick
+    const ObstacleArchetype *archetypes;
+    int archetype_count;                // At most MAX_ARCHETYPES
+    const DifficultyBand *schedule;
+    int band_count;
+
+    AliasTable obstacle_tables[DIFFICULTY_LEVELS];
+    JumpArc jump_arcs[NUM_JUMP_ARCS];
+    ObstacleClearance clearance[MAX_ARCHETYPES];
+} GameRules;
+
+extern GameRules game_rules;
+
+void build_game_rules(GameRules *rules);
+
+// Declare the buttons that play the game, as returned by getbtns(), and where the ground is
+#define BTN4 4 // Jump
+#define BTN3 2 // Duck
+#define GROUND_Y 31
+#define JUMP_CEILING 10 // A jump can only be extended while the top of the dino is below this row
+
+// Declare the state of one game. Every game function takes one, so games are independent
+// and a game can be saved or restored by copying the struct.
+typedef struct {
+    const GameRules *rules;             // Shared by every game played by the same rules
+
+    // The character
+    int32_t character_y_q8;             // Top of the character, in 1/256 pixels
+    int character_y;
+    int character_x;
+    int character_height;
+    int y_velocity;                     // In 1/256 pixels per tick, negative is up
+    characterAction action;
+    const Sprite *character;            // Frame shown (and hit) this tick
+    const Animation *character_animation;
+    int character_frame;
+    int dino_frames_passed;
+
+    // The obstacle
+    int32_t obstacle_x_q8;              // Left edge of the obstacle, in 1/256 pixels
+    int obstacle_x;
+    int obstacle_y;
+    int obstacle_speed;                 // In 1/256 pixels per tick, fixed when it spawns
+    const Sprite *obstacle;             // Frame shown (and hit) this tick
+    const ObstacleArchetype *obstacle_type;
+    int obstacle_frame;
+    int obstacle_ticks;                 // Ticks since the obstacle's animation frame last changed
+
+    // Positions at the start of the tick, for the swept collision test
+    int previous_obstacle_x;
+    int previous_character_y;
+    int previous_character_height;
+
+    // Progress of the run
+    int score;
+    uint32_t score_bcd;                 // The score as packed BCD, for the display and the LEDs
+    const DifficultyBand *difficulty;   // Band of the difficulty schedule for the score
+    int recovery_ticks;                 // Ticks the dino may still be in the air when the obstacle spawns
+    int spawn_pending;                  // Set while no obstacle could be spawned, retried every tick
+    int game_over;                      // Set when the character hits the obstacle
+
+    // The seed of the run and the random stream of the spawns derived from it
+    uint32_t seed;
+    Rng spawn_rng;
+} GameContext;
+
+// Declare the game shown on the display
+extern GameContext game;
+
+// Declare functions to run and draw a game
+void reset_game(GameContext *game, const GameRules *rules, uint32_t seed);
+void update_game(GameContext *game, int buttons);
+void reset_display(const GameContext *game);
+void update_display(const GameContext *game, const GameContext *ghost);
+
+// Declare the step of update_game() that scores a passed obstacle, for the batched engine of the host tools
+void pass_obstacle(GameContext *game);
+
+// Declare replays: the seed of a run and the buttons of every tick, as runs of ticks
+#define REPLAY_BYTES 512       // Room for the runs of one replay
+#define REPLAY_HEADER_BYTES 12 // Bytes before the runs when a replay is stored or sent
+#define REPLAY_MAGIC 0xD5      // First byte of a stored replay
+#define REPLAY_TRUNCATED 0x01  // Flag set when the run was longer than the replay has room for
+
+typedef struct {
+    uint32_t seed;
+    uint32_t score;             // Score the run ended with, to check a replay against
+    uint16_t length;            // Bytes of runs used
+    uint8_t flags;
+    uint8_t runs[REPLAY_BYTES]; // Buttons in the top 3 bits, ticks minus one in the low 5
+} Replay;
+
+typedef struct {
+    const Replay *replay;
+    int run;                    // Run being played
+    int ticks;                  // Ticks played of that run
+} ReplayCursor;
+
+// Declare the replay of the run being played, and of the top score's run
+extern Replay replay;
+extern Replay best_replay;
+extern int has_best_replay;
+
+void replay_start(Replay *replay, uint32_t seed);
+void replay_record(Replay *replay, int buttons);
+void replay_finish(Replay *replay, int score);
+void replay_cut(Replay *replay, uint32_t ticks);
+uint32_t replay_ticks(const Replay *replay);
+void replay_rewind(ReplayCursor *cursor, const Replay *replay);
+int replay_next(ReplayCursor *cursor);
+void replay_encode_header(const Replay *replay, uint8_t *header);
+int replay_decode_header(Replay *replay, const uint8_t *header);
+
+// Declare functions to store replays in the EEPROM and send them over the UART
+void write_replay(const Replay *replay);
+int read_replay(Replay *replay);
+void uart_init(void);
+void uart_send_replay(const Replay *replay);
+
+// Declare the rewind buffer: a keyframe of the whole game every REWIND_KEYFRAME_TICKS ticks,
+// and the buttons and a check of the state of every tick in between
+#define REWIND_KEYFRAMES 8
+#define REWIND_KEYFRAME_TICKS 32
+#define REWIND_TICKS (REWIND_KEYFRAMES * REWIND_KEYFRAME_TICKS)
+#define REWIND_LINE_BYTES 80 // Longest line of the debug dump, with the ending 0
+
+typedef struct {
+    GameContext keyframes[REWIND_KEYFRAMES]; // The state after every REWIND_KEYFRAME_TICKS ticks
+    uint8_t ticks[REWIND_TICKS];             // Buttons in the top 3 bits, check of the state in the low 5
+    uint32_t first;                          // Oldest tick that can be rebuilt, always on a keyframe
+    uint32_t end;                            // Ticks recorded, the newest tick that can be rebuilt
+} RewindBuffer;
+
+// Declare the rewind buffer of the run being played
+extern RewindBuffer rewind_buffer;
+
+int rewind_check(const GameContext *game);
+void rewind_start(RewindBuffer *rewind, const GameContext *game);
+void rewind_record(RewindBuffer *rewind, const GameContext *game, int buttons);
+int rewind_step(const RewindBuffer *rewind, GameContext *game, uint32_t tick);
+int rewind_load(const RewindBuffer *rewind, uint32_t tick, GameContext *game);
+void rewind_truncate(RewindBuffer *rewind, uint32_t tick);
+void rewind_format(char *line, uint32_t tick, int buttons, const GameContext *game, int matched);
+int rewind_buttons(const RewindBuffer *rewind, uint32_t tick);
+void uart_send_rewind(const RewindBuffer *rewind);
+
+// Declare the autopilot, which plays the game in the attract mode and in soak tests
+typedef struct {
+    int jump;   // Jump taken for the current obstacle, or -1 before takeoff
+    int score;  // Score when the current obstacle appeared
+    int jitter; // Most ticks it jumps too early or too late
+    int early;  // Ticks early (or late, if negative) that it jumps for the current obstacle
+    int delay;  // Ticks still to wait before a late takeoff
+    Rng rng;    // Picks early for every obstacle
+} Autopilot;
+
+void autopilot_reset(Autopilot *pilot, const GameContext *game, int jitter);
+int jump_clears(const GameContext *game, int arc, int delay);
+int autopilot_buttons(Autopilot *pilot, const GameContext *game);
+
+// Declare the benchmark of the drawing primitives, built with BENCH, and the clock it is timed with
+#define BENCH_LINE_BYTES 96 // Longest line of the results, with the ending 0
+
+typedef struct {
+    uint32_t (*read)(void);         // A free-running counter
+    uint32_t cycles_num;            // CPU cycles per tick of the counter, as cycles_num / cycles_den,
+    uint32_t cycles_den;            // or cycles_num 0 if they are not known
+    uint32_t ns_num;                // Nanoseconds per tick, as ns_num / ns_den
+    uint32_t ns_den;
+    int calls;                      // Calls timed in each round of a case
+    void (*send)(const char *line); // Sends one line of the results
+} BenchClock;
+
+void bench_run(const BenchClock *clock);
+void uart_puts(const char *s);
+
+// Declare the setup of the ChipKIT and the functions that read its switches and buttons
+void chip_init(void);
+int getsw(void);
+int getbtns(void);
+
+// Declare the functions in labfunc.S
+void enable_interrupt(void);
+uint32_t read_count(void);
+
 // Declare constants for leaderboard entries and initials length
 #define NUM_LEADERBOARD_ENTRIES 6
 #define INITIALS_LENGTH 3
@@ -79,5 +415,13 @@ extern char leaderboard_initials[NUM_LEADERBOARD_ENTRIES][INITIALS_LENGTH];
 
 // Declare global variables for leaderboard stuff
 extern int letter_index;
-extern char initials[3];
-extern int leaderboard_index;
\ No newline at end of file
+extern char initials[INITIALS_LENGTH + 1];
+extern int leaderboard_index;
+
+// Declare functions for the leaderboard in the EEPROM and the score on the LEDs
+void update_LEDs(uint32_t score_bcd);
+void read_multiple_scores(uint8_t *scores, int size);
+void read_leaderboard(void);
+void draw_leaderboard(void);
+void insert_initials(char *initials, int index);
+void insert_score(uint8_t score);
@@ -2,13 +2,14 @@
  * @file display.c
  * @brief Functions for controlling and manipulating the display.
  *
- * This file contains functions for initializing the display, drawing pixels, rectangles, characters, numbers, and images on the display, and updating the display with the pixel data.
+ * This file contains functions for drawing pixels, rectangles, characters, numbers, and images into the frame buffer.
  * The display is divided into 4 sections, each represented by a 128x32 pixel array in the `pixel_data` variable.
- * The functions in this file use SPI communication to send data to the display module.
+ * Nothing in this file touches the hardware, so it also builds on the host for the tools in `tools/`.
  * The display can be cleared, and individual pixels can be set or cleared using the `set_pixel()` and `clear_pixel()` functions.
- * Characters and numbers can be drawn on the display using the `draw_char()`, `draw_string()`, `draw_digit()`, and `draw_number()` functions.
+ * Characters and numbers can be drawn on the display using the `draw_char()`, `draw_string()`, `draw_digit()`, and `draw_number()` functions,
+ * which blit whole glyph columns from the packed `font` table.
  * Images can be drawn on the display using the `draw_image()` function.
- * The `display_objects()` function updates the display with the pixel data stored in the `pixel_data` array.
+ * The `display_objects()` function in oled.c updates the display with the pixel data stored in the `pixel_data` array.
  *
  * @author Axel Isaksson
  * @author F Lundevall  
@@ -21,66 +22,10 @@
  */
 
 #include <stdint.h>   /* Declarations of uint_32 and the like */
-#include <pic32mx.h>  /* Declarations of system-specific addresses etc */
 #include "declare.h"  /* Declatations for these labs */
 #include <stdio.h>
 #include <string.h>
 
-#define DISPLAY_CHANGE_TO_COMMAND_MODE (PORTFCLR = 0x10)
-#define DISPLAY_CHANGE_TO_DATA_MODE (PORTFSET = 0x10)
-#define DISPLAY_ACTIVATE_RESET (PORTGCLR = 0x200)
-#define DISPLAY_DO_NOT_RESET (PORTGSET = 0x200)
-#define DISPLAY_ACTIVATE_VDD (PORTFCLR = 0x40)
-#define DISPLAY_ACTIVATE_VBAT (PORTFCLR = 0x20)
-#define DISPLAY_TURN_OFF_VDD (PORTFSET = 0x40)
-#define DISPLAY_TURN_OFF_VBAT (PORTFSET = 0x20)
-
-/* quicksleep:
-   A simple function to create a small delay.
-   Very inefficient use of computing resources,
-   but very handy in some special cases. */
-void quicksleep(int cyc) {
-	int i;
-	for(i = cyc; i > 0; i--);
-}
-
-uint8_t spi_send_recv(uint8_t data) {
-	while(!(SPI2STAT & 0x08));
-	SPI2BUF = data;
-	while(!(SPI2STAT & 1));
-	return SPI2BUF;
-}
-
-void display_init(void) {
-    DISPLAY_CHANGE_TO_COMMAND_MODE;
-	quicksleep(10);
-	DISPLAY_ACTIVATE_VDD;
-	quicksleep(1000000);
-	
-	spi_send_recv(0xAE);
-	DISPLAY_ACTIVATE_RESET;
-	quicksleep(10);
-	DISPLAY_DO_NOT_RESET;
-	quicksleep(10);
-	
-	spi_send_recv(0x8D);
-	spi_send_recv(0x14);
-	
-	spi_send_recv(0xD9);
-	spi_send_recv(0xF1);
-	
-	DISPLAY_ACTIVATE_VBAT;
-	quicksleep(10000000);
-	
-	spi_send_recv(0xA1);
-	spi_send_recv(0xC8);
-	
-	spi_send_recv(0xDA);
-	spi_send_recv(0x20);
-	
-	spi_send_recv(0xAF);
-}
-
 /*
  * itoa
  * 
@@ -165,31 +110,121 @@ char * itoaconv( int num )
 // ---------------------------------------------------------------------------------------------
 // Code by Elias Hollstrand and Mattias Kvist
 
-// array for pixel data
-uint8_t pixel_data[4][128];
+// array for pixel data, word aligned so that whole layers can be copied 32 bits at a time
+uint8_t pixel_data[4][128] __attribute__((aligned(4)));
+
+// Area that drawing is limited to, the whole display unless set_clip() narrowed it
+ClipRect clip_rect = { 0, 0, 128, 32 };
+
+// Columns of each page that changed since the last call to display_objects(), [start, end)
+uint8_t dirty_start[4] = { 0, 0, 0, 0 };
+uint8_t dirty_end[4] = { 128, 128, 128, 128 };
+
+/**
+ * @brief Marks a rectangle of the display as changed, so display_objects() sends it.
+ *
+ * Whole pages are tracked, so the rectangle is widened to the pages it touches.
+ * Parts of the rectangle outside the display are ignored.
+ *
+ * @param x The x-coordinate of the top-left corner of the rectangle.
+ * @param y The y-coordinate of the top-left corner of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ */
+void mark_dirty(int x, int y, int width, int height) {
+	int x1 = x + width;
+	int y1 = y + height;
+
+	if(x < 0) x = 0;
+	if(y < 0) y = 0;
+	if(x1 > 128) x1 = 128;
+	if(y1 > 32) y1 = 32;
+	if(x >= x1 || y >= y1) {
+		return;
+	}
+
+	int page;
+	for(page = y >> 3; page <= (y1 - 1) >> 3; page++) {
+		if(x < dirty_start[page]) dirty_start[page] = x;
+		if(x1 > dirty_end[page]) dirty_end[page] = x1;
+	}
+}
+
+/**
+ * @brief Limits all following drawing to a rectangle of the display.
+ *
+ * The rectangle is clipped to the display, so drawing never writes outside pixel_data.
+ * Used to draw into a viewport; call reset_clip() afterwards.
+ *
+ * @param x The x-coordinate of the top-left corner of the rectangle.
+ * @param y The y-coordinate of the top-left corner of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ */
+void set_clip(int x, int y, int width, int height) {
+	clip_rect.x0 = x < 0 ? 0 : x;
+	clip_rect.y0 = y < 0 ? 0 : y;
+	clip_rect.x1 = x + width > 128 ? 128 : x + width;
+	clip_rect.y1 = y + height > 32 ? 32 : y + height;
+}
+
+/**
+ * @brief Lets drawing use the whole display again.
+ */
+void reset_clip(void) {
+	clip_rect.x0 = 0;
+	clip_rect.y0 = 0;
+	clip_rect.x1 = 128;
+	clip_rect.y1 = 32;
+}
+
+/**
+ * @brief Marks the whole display as changed.
+ */
+void mark_all_dirty(void) {
+	int page;
+	for(page = 0; page < 4; page++) {
+		dirty_start[page] = 0;
+		dirty_end[page] = 128;
+	}
+}
 
 /**
  * @brief Sets a pixel at the specified coordinates.
  *
+ * Pixels outside the clip rectangle are ignored.
+ *
  * @param x The x-coordinate of the pixel.
  * @param y The y-coordinate of the pixel.
  */
 void set_pixel(int x, int y) {
+	if(x < clip_rect.x0 || x >= clip_rect.x1 || y < clip_rect.y0 || y >= clip_rect.y1) {
+		return;
+	}
+
 	int row = y / 8; // 8 pixels per row
 	int col = x; // 128 pixels per column
 	pixel_data[row][col] |= 1 << (y % 8); // set bit at position y%8
+	mark_dirty(x, y, 1, 1);
 }
 
 /**
  * @brief Clears the pixel at the specified coordinates.
  *
+ * Pixels outside the clip rectangle are ignored.
+ *
  * @param x The x-coordinate of the pixel.
  * @param y The y-coordinate of the pixel.
  */
 void clear_pixel(int x, int y) {
+	if(x < clip_rect.x0 || x >= clip_rect.x1 || y < clip_rect.y0 || y >= clip_rect.y1) {
+		return;
+	}
+
 	int row = y / 8; // 8 pixels per row
 	int col = x; // 128 pixels per column
 	pixel_data[row][col] &= ~(1 << (y % 8)); // clear bit at position y%8
+	mark_dirty(x, y, 1, 1);
 }
 
 /**
@@ -208,11 +243,104 @@ void clear_all_pixels() {
 			pixel_data[i][j] = 0;
 		}
 	}
+	mark_all_dirty();
+}
+
+/**
+ * @brief Copies the current contents of the pixel_data array into a layer.
+ *
+ * Used to pre-render parts of the screen that do not change between frames,
+ * so that they can later be restored with load_layer() instead of being drawn again.
+ *
+ * @param layer The word aligned layer buffer to store the pixel data in.
+ */
+void store_layer(uint8_t layer[4][128]) {
+	const uint32_t *src = (const uint32_t *)pixel_data;
+	uint32_t *dst = (uint32_t *)layer;
+
+	int i;
+	for(i = 0; i < (4 * 128) / 4; i++) {
+		dst[i] = src[i];
+	}
+}
+
+/**
+ * @brief Replaces the contents of the pixel_data array with a pre-rendered layer.
+ *
+ * The copy is done one 32-bit word at a time, four words per iteration,
+ * which makes starting a frame from a layer as cheap as clearing it.
+ *
+ * @param layer The word aligned layer buffer to copy from.
+ */
+void load_layer(const uint8_t layer[4][128]) {
+	const uint32_t *src = (const uint32_t *)layer;
+	uint32_t *dst = (uint32_t *)pixel_data;
+
+	int i;
+	for(i = 0; i < (4 * 128) / 4; i += 4) {
+		dst[i] = src[i];
+		dst[i + 1] = src[i + 1];
+		dst[i + 2] = src[i + 2];
+		dst[i + 3] = src[i + 3];
+	}
+	mark_all_dirty();
+}
+
+/**
+ * @brief Restores a rectangle of the pixel_data array from a pre-rendered layer.
+ *
+ * Whole pages are copied, so every column of the rectangle is restored from the
+ * top of its first page to the bottom of its last page. This erases sprites drawn
+ * over the layer in that area without redrawing the rest of the frame.
+ *
+ * @param layer The layer to copy from.
+ * @param x The x-coordinate of the top-left corner of the rectangle.
+ * @param y The y-coordinate of the top-left corner of the rectangle.
+ * @param width The width of the rectangle.
+ * @param height The height of the rectangle.
+ */
+void restore_rect(const uint8_t layer[4][128], int x, int y, int width, int height) {
+	int x1 = x + width;
+	int y1 = y + height;
+
+	if(x < 0) x = 0;
+	if(y < 0) y = 0;
+	if(x1 > 128) x1 = 128;
+	if(y1 > 32) y1 = 32;
+	if(x >= x1 || y >= y1) {
+		return;
+	}
+
+	int page, col;
+	for(page = y >> 3; page <= (y1 - 1) >> 3; page++) {
+		for(col = x; col < x1; col++) {
+			pixel_data[page][col] = layer[page][col];
+		}
+	}
+	mark_dirty(x, y, x1 - x, y1 - y);
+}
+
+/**
+ * @brief Returns the bits of a page that lie within rows [y0, y1), or 0 if none do.
+ */
+static uint8_t page_mask(int page, int y0, int y1) {
+	int top = y0 - page * 8;
+	int bottom = y1 - page * 8;
+
+	if(top >= 8 || bottom <= 0) {
+		return 0;
+	}
+	if(top < 0) top = 0;
+	if(bottom > 8) bottom = 8;
+	return (0xFF << top) & (0xFF >> (8 - bottom));
 }
 
 /**
  * Fills a rectangle with pixels.
  *
+ * The rectangle is clipped to the clip rectangle and then filled a page at a
+ * time, setting the bits of all its rows in a column with a single OR.
+ *
  * @param x0 The x-coordinate of the top-left corner of the rectangle.
  * @param y0 The y-coordinate of the top-left corner of the rectangle.
  * @param w The width of the rectangle.
@@ -221,85 +349,132 @@ void clear_all_pixels() {
 void fill_rectangle(int x0, int y0, int w, int h) {
 	int x1 = x0 + w;
 	int y1 = y0 + h;
-	
-	int i, j;
-	for(i = x0; i < x1; i++) {
-		for(j = y0; j < y1; j++) {
-			set_pixel(i, j);
+
+	if(x0 < clip_rect.x0) x0 = clip_rect.x0;
+	if(y0 < clip_rect.y0) y0 = clip_rect.y0;
+	if(x1 > clip_rect.x1) x1 = clip_rect.x1;
+	if(y1 > clip_rect.y1) y1 = clip_rect.y1;
+	if(x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	mark_dirty(x0, y0, x1 - x0, y1 - y0);
+
+	int page, i;
+	for(page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+		uint8_t bits = page_mask(page, y0, y1);
+		uint8_t *dst = pixel_data[page];
+		for(i = x0; i < x1; i++) {
+			dst[i] |= bits;
 		}
 	}
 }
 
 /**
- * @brief Updates the display with the pixel data stored in the pixel_data array.
- * 
- * This function sends the pixel data stored in the pixel_data array to the display.
- * It uses SPI communication to send the data to the display module.
- * The display is divided into 4 sections, and this function updates each section with the corresponding pixel data.
- * 
- * @note This function is based on display_update from labs.
+ * @brief Blits packed columns into the pixel_data array, clipped to the clip rectangle.
+ *
+ * The visible part of the source is worked out once, up front: the range of columns,
+ * the source pages that reach the visible rows and a mask of the visible rows in
+ * every destination page. The inner loops then copy columns without any bounds checks.
+ * Each source page is shifted down by y % 8 rows, so it is ORed into the page it
+ * starts in and the one below it. Only the visible area is marked dirty.
+ *
+ * @param x The x-coordinate of the top-left corner of the image.
+ * @param y The y-coordinate of the top-left corner of the image.
+ * @param data The packed columns, one page of the image after the other.
+ * @param stride The number of bytes from one page of the source to the next.
+ * @param width The number of columns to draw.
+ * @param height The number of rows to draw.
  */
-// Based on display_update from labs
-void display_objects(void) {
-	int i, j, k;
-	int c;
-	for(i = 0; i < 4; i++) {
-		DISPLAY_CHANGE_TO_COMMAND_MODE;
-		spi_send_recv(0x22);
-		spi_send_recv(i);
-		
-		spi_send_recv(0x0);
-		spi_send_recv(0x10);
-		
-		DISPLAY_CHANGE_TO_DATA_MODE;
-		
-		for(j = 0; j < 128; j++) {
-			spi_send_recv(pixel_data[i][j]);
+void blit_packed(int x, int y, const uint8_t *data, int stride, int width, int height) {
+	int x0 = x < clip_rect.x0 ? clip_rect.x0 : x;
+	int y0 = y < clip_rect.y0 ? clip_rect.y0 : y;
+	int x1 = x + width > clip_rect.x1 ? clip_rect.x1 : x + width;
+	int y1 = y + height > clip_rect.y1 ? clip_rect.y1 : y + height;
+
+	if(x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	mark_dirty(x0, y0, x1 - x0, y1 - y0);
+
+	int shift = y & 7;
+	int first_page = y >> 3; // page that source page 0 starts in
+	int count = x1 - x0;
+	int last = (y1 - 1 - y) >> 3;
+	int source_page;
+
+	data += x0 - x;
+	for(source_page = (y0 - y) >> 3; source_page <= last; source_page++) {
+		const uint8_t *src = data + source_page * stride;
+		int page = first_page + source_page;
+		uint8_t upper_mask = page_mask(page, y0, y1);
+		uint8_t lower_mask = shift ? page_mask(page + 1, y0, y1) : 0;
+		uint8_t *upper = pixel_data[page & 3] + x0;
+		uint8_t *lower = pixel_data[(page + 1) & 3] + x0;
+		int i;
+
+		if(upper_mask && lower_mask) {
+			for(i = 0; i < count; i++) {
+				uint16_t bits = src[i] << shift;
+				upper[i] |= bits & upper_mask;
+				lower[i] |= (bits >> 8) & lower_mask;
+			}
+		} else if(upper_mask) {
+			for(i = 0; i < count; i++) {
+				upper[i] |= (src[i] << shift) & upper_mask;
+			}
+		} else if(lower_mask) {
+			for(i = 0; i < count; i++) {
+				lower[i] |= (src[i] >> (8 - shift)) & lower_mask;
+			}
 		}
 	}
 }
 
+/**
+ * @brief Blits a run of packed glyph columns into the pixel_data array.
+ *
+ * Each column holds up to 8 pixels, bit 0 being the top row. The columns are drawn
+ * with blit_packed(), which clips them to the clip rectangle.
+ *
+ * @param x The x-coordinate of the first column.
+ * @param y The y-coordinate of the top row of the columns.
+ * @param columns The packed columns.
+ * @param count The number of columns to draw.
+ */
+void draw_columns(int x, int y, const uint8_t *columns, int count) {
+	blit_packed(x, y, columns, count, count, 8);
+}
+
+/**
+ * @brief Looks up the glyph of a character in the font.
+ *
+ * Uppercase letters use the lowercase glyphs, and characters outside the
+ * printable ASCII range are shown as a question mark.
+ *
+ * @param c The character to look up.
+ * @return A pointer to the 5 packed columns of the glyph.
+ */
+const uint8_t *font_glyph(char c) {
+	if(c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR) {
+		c = '?';
+	}
+	return font[c - FONT_FIRST_CHAR];
+}
+
 /**
  * @brief Draws a character on the display.
  *
  * This function takes the coordinates (x, y) and a character 'c' as input and draws the corresponding character on the display.
- * The character is represented by an array of bits stored in the 'letters' array.
- * If the character is a number (ASCII value between 48 and 57), the corresponding number array is used instead.
- * The function iterates over the bits of the character array and draws a pixel at the corresponding position on the display if the bit is 1.
+ * The character is looked up in the packed 'font' table and its 5 columns are blitted with draw_columns().
  *
  * @param x The x-coordinate of the character's top-left corner.
  * @param y The y-coordinate of the character's top-left corner.
  * @param c The character to be drawn.
  */
 void draw_char(int x, int y, char c) {
-	int char_number;
-	if(c == 32) {
-		char_number = 26; // Space
-	} else if(c == 58) {
-		char_number = 27; // Colon
-	} else {
-		char_number = c - 'a';
-	}
-	const uint8_t* data = letters[char_number];
-
-	if(48 <= c && c <= 57) { // Numbers
-		char_number = c - '0';
-		data = numbers[char_number];
-
-		int i = 0;
-		for(; i < 20; i++) { // 20 bits per number (4x5)
-			if(data[i] == 1) {
-				set_pixel(x + i % 4, y + i / 4);
-			}
-		}
-	} else {
-		int i = 0;
-		for(; i < 25; i++) { // 25 bits per letter (5x5)
-			if(data[i] == 1) {
-				set_pixel(x + i % 5, y + i / 5);
-			}
-		}
-	}
+	draw_columns(x, y, font_glyph(c), FONT_WIDTH);
 }
 
 /**
@@ -310,10 +485,10 @@ void draw_char(int x, int y, char c) {
  * @param s The string to be drawn.
  */
 void draw_string(int x, int y, char* s) {	
-	int i = 0;
-	while(s[i]) {
-		draw_char(x + i * 6, y, s[i]);
-		i++;
+	while(*s) {
+		draw_columns(x, y, font_glyph(*s), FONT_WIDTH);
+		x += FONT_WIDTH + 1;
+		s++;
 	}
 }
  
@@ -322,24 +497,14 @@ void draw_string(int x, int y, char* s) {
  *
  * This function takes in the x and y coordinates of the top-left corner of the digit
  * and the character representing the digit to be drawn. The character should be a digit
- * from '0' to '9'. The function assumes that there is a 2D array called 'numbers' which
- * contains the pixel data for each digit.
+ * from '0' to '9'. Digits are 4 columns wide, so only the first 4 columns of the glyph are drawn.
  *
  * @param x The x-coordinate of the top-left corner of the digit.
  * @param y The y-coordinate of the top-left corner of the digit.
  * @param n The character representing the digit to be drawn.
  */
 void draw_digit(int x, int y, char n) {
-	int number = n - '0';
-	const uint8_t* data = numbers[number];
-
-	int i = 0;
-	for(; i < 20; i++) {
-		// if the bit is 1, draw a pixel
-		if(data[i] == 1) {
-			set_pixel(x + i % 4, y + i / 4);
-		}
-	}
+	draw_columns(x, y, font_glyph(n), DIGIT_WIDTH);
 }
 
 /**
@@ -363,37 +528,269 @@ void draw_number(int x, int y, int n) {
 	}
 }
 
+/**
+ * @brief Draws a number in hexadecimal on the display, with leading zeros.
+ *
+ * @param x The x-coordinate of the starting position of the number.
+ * @param y The y-coordinate of the starting position of the number.
+ * @param value The number to be drawn.
+ * @param digits The number of hexadecimal digits to draw, most significant first.
+ */
+void draw_hex(int x, int y, uint32_t value, int digits) {
+	int i;
+	for(i = digits - 1; i >= 0; i--) {
+		int digit = (value >> (4 * i)) & 0xF;
+		draw_char(x, y, digit < 10 ? '0' + digit : 'a' + digit - 10);
+		x += FONT_WIDTH + 1;
+	}
+}
+
+/**
+ * @brief Draws a packed BCD number into a layer, redrawing only the digits that changed.
+ *
+ * Each nibble of bcd is one decimal digit, most significant nibble first on screen.
+ * Digits are blitted one column at a time from the font, so no division is needed.
+ * If the number of digits differs from previous, every digit position is redrawn,
+ * and the positions of previous digits beyond the new last one are cleared.
+ * Pass 0xFFFFFFFF as previous to force a full redraw, which clears nothing beyond the digits.
+ * The digits must fit within a single page, i.e. y % 8 must be at most 3.
+ *
+ * @param layer The layer to draw into (pixel_data or a pre-rendered layer).
+ * @param x The x-coordinate of the leftmost digit.
+ * @param y The y-coordinate of the top of the digits.
+ * @param bcd The number to draw, as packed BCD.
+ * @param previous The number currently drawn at this position, as packed BCD.
+ */
+void draw_bcd(uint8_t layer[4][128], int x, int y, uint32_t bcd, uint32_t previous) {
+	uint8_t *page = layer[y >> 3];
+	int shift = y & 7;
+	uint8_t keep = ~(0x1F << shift);
+
+	int digits = 1;
+	while(digits < 8 && (bcd >> (4 * digits))) {
+		digits++;
+	}
+
+	int previous_digits = 1;
+	while(previous_digits < 8 && (previous >> (4 * previous_digits))) {
+		previous_digits++;
+	}
+
+	int i, col;
+	if(digits != previous_digits) {
+		for(i = digits; i < previous_digits && previous != 0xFFFFFFFF; i++) { // e.g. rewinding from 10 to 9
+			int dx = x + i * (DIGIT_WIDTH + 1);
+			for(col = 0; col < DIGIT_WIDTH; col++) {
+				page[dx + col] &= keep;
+			}
+			if(layer == pixel_data) {
+				mark_dirty(dx, y, DIGIT_WIDTH, FONT_HEIGHT);
+			}
+		}
+		previous = ~bcd; // every nibble differs, so everything is redrawn
+	}
+
+	for(i = 0; i < digits; i++) {
+		int nibble = 4 * (digits - 1 - i);
+		int digit = (bcd >> nibble) & 0xF;
+
+		if(digit != ((previous >> nibble) & 0xF)) {
+			const uint8_t *glyph = font['0' + digit - FONT_FIRST_CHAR];
+			int dx = x + i * (DIGIT_WIDTH + 1);
+			for(col = 0; col < DIGIT_WIDTH; col++) {
+				page[dx + col] = (page[dx + col] & keep) | (glyph[col] << shift);
+			}
+			if(layer == pixel_data) {
+				mark_dirty(dx, y, DIGIT_WIDTH, FONT_HEIGHT);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Draws a pre-shifted sprite that is completely on screen.
+ *
+ * The copy of the sprite that is already moved down by y % 8 rows is picked, so
+ * every byte of it lines up with a page and is simply ORed into pixel_data.
+ * Only the pages that the sprite actually covers at this y are written.
+ *
+ * @param x The x-coordinate of the top-left corner of the sprite.
+ * @param y The y-coordinate of the top-left corner of the sprite.
+ * @param sprite The sprite to draw, which must have pre-shifted copies.
+ */
+void draw_preshifted(int x, int y, const Sprite *sprite) {
+	int width = sprite->width;
+	int stride = PRESHIFT_PAGES(sprite->height) * width;
+	int pages = ((y & 7) + sprite->height + 7) >> 3;
+	const uint8_t *src = sprite->shifted + (y & 7) * stride;
+	uint8_t *dst = &pixel_data[y >> 3][x];
+
+	int page, col;
+	for(page = 0; page < pages; page++) {
+		for(col = 0; col < width; col++) {
+			dst[col] |= src[col];
+		}
+		src += width;
+		dst += 128;
+	}
+}
+
+/**
+ * @brief Draws a run-length encoded sprite, clipping it while decoding.
+ *
+ * Runs of empty columns are skipped without touching pixel_data, and literal runs
+ * are blitted with draw_columns(), so the cost depends on the ink in the sprite
+ * rather than its area. Pages that fall outside the clip rectangle are skipped record
+ * by record without drawing anything.
+ *
+ * @param x The x-coordinate of the top-left corner of the sprite.
+ * @param y The y-coordinate of the top-left corner of the sprite.
+ * @param sprite The run-length encoded sprite to draw.
+ */
+void draw_rle(int x, int y, const Sprite *sprite) {
+	const uint8_t *data = sprite->data;
+	int width = sprite->width;
+
+	int row = 0;
+	for(; row < sprite->height; row += 8) {
+		int visible = y + row + 8 > clip_rect.y0 && y + row < clip_rect.y1;
+
+		int col = 0;
+		while(col < width) {
+			col += data[0];
+			int count = data[1];
+			data += 2;
+
+			if(visible && count) {
+				draw_columns(x + col, y + row, data, count);
+			}
+			data += count;
+			col += count;
+		}
+	}
+}
+
 /**
  * @brief Draws an image on the display at the specified position.
  *
+ * Sprites that have pre-shifted copies or a compiled blit function use them when they are completely inside the clip rectangle.
+ * Otherwise run-length encoded sprites are drawn by draw_rle(), and packed sprites by
+ * blit_packed(), which clips them against the clip rectangle.
+ *
  * @param x The x-coordinate of the top-left corner of the image.
  * @param y The y-coordinate of the top-left corner of the image.
- * @param width The width of the image.
- * @param height The height of the image.
- * @param data A pointer to the image data.
+ * @param sprite The sprite to draw.
  */
-void draw_image(int x, int y, int width, int height, const uint8_t *data) {
-	int outOfBounds = -x;
+void draw_image(int x, int y, const Sprite *sprite) {
+	if(x >= clip_rect.x0 && y >= clip_rect.y0 && x + sprite->width <= clip_rect.x1 && y + sprite->height <= clip_rect.y1) {
+		if(sprite->shifted) {
+			mark_dirty(x, y, sprite->width, sprite->height);
+			draw_preshifted(x, y, sprite);
+			return;
+		}
+		if(sprite->blit) {
+			mark_dirty(x, y, sprite->width, sprite->height);
+			sprite->blit(x, y);
+			return;
+		}
+	}
 
-	int i = 0;
-	for(; i < width * height; i++) {
-		int col = i % width;
-		int row = i / width;
-
-		if(outOfBounds > 0){
-			if(col >= outOfBounds) {
-				if(data[i] == 1) {
-					set_pixel(x + col, y + row);
-				}
-			}
-		} else {
-			if(data[i] == 1) {
-				set_pixel(x + col, y + row);
-			}
+	if(sprite->encoding == SPRITE_RLE) {
+		draw_rle(x, y, sprite);
+		return;
+	}
+
+	blit_packed(x, y, sprite->data, sprite->width, sprite->width, sprite->height);
+}
+
+/**
+ * @brief Draws a packed sprite dithered, with only every other pixel of it set.
+ *
+ * The pixels kept form a checkerboard fixed to the screen, so the sprite looks grey
+ * and stays apart from what is drawn solid under it. Clipping works like blit_packed().
+ *
+ * @param x The x-coordinate of the top-left corner of the sprite.
+ * @param y The y-coordinate of the top-left corner of the sprite.
+ * @param sprite The sprite to draw, which must not be run-length encoded.
+ */
+void draw_dithered(int x, int y, const Sprite *sprite) {
+	int x0 = x < clip_rect.x0 ? clip_rect.x0 : x;
+	int y0 = y < clip_rect.y0 ? clip_rect.y0 : y;
+	int x1 = x + sprite->width > clip_rect.x1 ? clip_rect.x1 : x + sprite->width;
+	int y1 = y + sprite->height > clip_rect.y1 ? clip_rect.y1 : y + sprite->height;
+
+	if(x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	mark_dirty(x0, y0, x1 - x0, y1 - y0);
+
+	int shift = y & 7;
+	int count = x1 - x0;
+	int last = (y1 - 1 - y) >> 3;
+	const uint8_t *data = sprite->data + (x0 - x);
+	int source_page;
+
+	for(source_page = (y0 - y) >> 3; source_page <= last; source_page++) {
+		const uint8_t *src = data + source_page * sprite->width;
+		int page = (y >> 3) + source_page;
+		uint8_t upper_mask = page_mask(page, y0, y1);
+		uint8_t lower_mask = shift ? page_mask(page + 1, y0, y1) : 0;
+		uint8_t *upper = pixel_data[page & 3] + x0;
+		uint8_t *lower = pixel_data[(page + 1) & 3] + x0;
+		uint16_t dither = (x0 & 1) ? 0xAAAA : 0x5555; // Pages start on even rows, so the pattern lines up
+		int i;
+
+		for(i = 0; i < count; i++) {
+			uint16_t bits = (src[i] << shift) & dither;
+			upper[i] |= bits & upper_mask;
+			lower[i] |= (bits >> 8) & lower_mask;
+			dither = ~dither;
 		}
 	}
 }
 
+/**
+ * @brief Draws a range of columns of a packed sprite.
+ *
+ * @param x The x-coordinate of the top-left corner of the whole sprite.
+ * @param y The y-coordinate of the top-left corner of the whole sprite.
+ * @param sprite The sprite to draw, which must not be run-length encoded.
+ * @param first The first column of the sprite to draw.
+ * @param count The number of columns to draw.
+ */
+void draw_image_columns(int x, int y, const Sprite *sprite, int first, int count) {
+	blit_packed(x + first, y, sprite->data + first, sprite->width, count, sprite->height);
+}
+
+/**
+ * @brief Switches an animation drawn at (x, y) to the given frame.
+ *
+ * The animation must already be drawn at this position with the previous frame,
+ * on top of the given layer. Only the column spans that differ between the two
+ * frames are restored from the layer and drawn again, so only those columns are
+ * marked dirty and sent to the display.
+ *
+ * @param layer The layer the animation is drawn on top of.
+ * @param x The x-coordinate of the top-left corner of the animation.
+ * @param y The y-coordinate of the top-left corner of the animation.
+ * @param animation The animation to step.
+ * @param frame The frame to switch to.
+ */
+void draw_animation_step(const uint8_t layer[4][128], int x, int y, const Animation *animation, int frame) {
+	const Sprite *sprite = animation->frames[frame];
+	const uint8_t *span = animation->spans + animation->span_offsets[frame];
+
+	int i = 0;
+	for(; i < span[0]; i++) {
+		int first = span[1 + 2 * i];
+		int count = span[2 + 2 * i];
+
+		restore_rect(layer, x + first, y, count, sprite->height);
+		draw_image_columns(x, y, sprite, first, count);
+	}
+}
+
 /**
  * @brief Copies a substring from the source string to the destination string.
  *
@@ -19,7 +19,7 @@
 
 char leaderboard_initials[NUM_LEADERBOARD_ENTRIES][INITIALS_LENGTH];
 
-char initials[3] = {'a', 'a', 'a'};
+char initials[INITIALS_LENGTH + 1] = "aaa"; // Ended by a 0, so it can be drawn as a string
 
 int letter_index = 0;
 
@@ -35,7 +35,7 @@ void draw_enter_name() {
     draw_string(0, 8, "you got a highscore");
     draw_string(0, 16, "enter name:");
     draw_string(75, 16, initials);
-    draw_image(75 + letter_index * 6, 24, 5, 5, arrow_up);
+    draw_image(75 + letter_index * 6, 24, &arrow_up);
     draw_string(0, 24, "btn3:save");
     display_objects();
 }
\ No newline at end of file
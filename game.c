@@ -4,13 +4,12 @@
  *
  * This file defines the game logic and display functions for a simple side-scrolling dino runner game.
  * It includes functions for updating the game state, drawing the ground, character, and obstacles,
- * checking for collisions, and generating random numbers. The game state includes variables for
- * the character's position, height, and width, the obstacle's position, height, and width,
- * the character's action, the score, and the highscore. The display functions are responsible
- * for updating the display by clearing all pixels, drawing the ground, character, obstacles,
- * score, and highscore, and displaying the objects. The game logic functions handle moving
- * the character, moving the obstacle, checking for collisions, and spawning new obstacles.
- * There is also a function for resetting the game state to its initial values.
+ * checking for collisions, and spawning obstacles. The state of a run (the character, the obstacle,
+ * the score, the difficulty and the random stream) lives in a GameContext that is passed to every
+ * function, so any number of games can run side by side and a game can be saved or restored with a
+ * single copy. The game logic functions only read the buttons they are given and never touch the
+ * hardware; the caller deals with the end of a run. The display functions draw one context on the
+ * screen, redrawing only what changed since the last frame.
  *
  * @author Axel Isaksson
  * @author F Lundevall
@@ -23,56 +22,81 @@
  */
 
 #include <stdint.h>	 /* Declarations of uint_32 and the like */
-#include <pic32mx.h> /* Declarations of system-specific addresses etc */
 #include "declare.h" /* Declatations for these labs */
 
 #define OBSTACLE_SPAWN_X 127
 #define BIG_OBSTACLE_HEIGHT 10
 #define SMALL_OBSTACLE_HEIGHT 5
-#define SMALL_CACTUS_WIDTH 6
-#define SMALL_CACTUS_HEIGHT 11
-#define BIG_CACTUS_WIDTH 8
-#define BIG_CACTUS_HEIGHT 14
-#define BIRD_WIDTH 12
-#define BIRD_HEIGHT 6
-#define JUMP_VELOCITY -4
-#define GRAVITY 0.4f
-#define GROUND_Y 31
+#define JUMP_VELOCITY (-4 * 256) // Default, in 1/256 pixels per tick, negative is up
+#define GRAVITY 102               // Default, 0.4 pixels per tick per tick, in 1/256 pixels
 #define MID_AIR_Y 25
 #define HIGH_AIR_Y GROUND_Y - 11
-#define DINO_STANDING_WIDTH 13
-#define DINO_STANDING_HEIGHT 15
-#define DINO_DUCKING_HEIGHT 10
-#define DINO_DUCKING_WIDTH 20
 
-#define BTN4 4
-#define BTN3 2
-
-int character_x;
-float character_y;
-int character_height;
-int character_width;
-int obstacle_x;
-int obstacle_y;
-int obstacle_height;
-int obstacle_width;
-float y_velocity;
-float speed;
-
-int score = 0;
-int highscore;
-int dino_frames_passed = 0;
-int bird_frames_passed = 0;
-
-characterAction action;
-const uint8_t *obstacle;
-
-int leaderboard_index;
+#define SPAWN_ATTEMPTS 4 // Draws of an archetype before the spawn is put off to the next tick
+
+#define SWEEP_STEP 2 // Largest movement in pixels between two collision tests, longer moves are sub-stepped
+
+#define SCORE_X 35
+#define SCORE_Y 0
+#define SCORE_DIGITS 8
+
+#define NUM_OBSTACLE_ARCHETYPES 4
+
+// Everything that can be spawned. Adding an obstacle only takes a row here.
+const ObstacleArchetype obstacle_archetypes[NUM_OBSTACLE_ARCHETYPES] = {
+	//  sprite         animation   period  bottom      velocity  weights per difficulty level
+	{ &cactus_small,  0,          0,      GROUND_Y,   256,      { 4, 3, 2, 2 } },
+	{ &cactus_big,    0,          0,      GROUND_Y,   256,      { 2, 3, 3, 3 } },
+	{ &bird1,         &bird_flap, 3,      MID_AIR_Y,  256,      { 0, 1, 2, 2 } }, // Low bird, jump over it
+	{ &bird1,         &bird_flap, 3,      HIGH_AIR_Y, 256,      { 0, 1, 2, 2 } }, // High bird, duck under it
+};
+
+#define NUM_DIFFICULTY_BANDS 12
+
+// How the game gets harder as the score goes up. Birds only appear from level 1, at a score of 20.
+const DifficultyBand difficulty_schedule[NUM_DIFFICULTY_BANDS] = {
+	//  score  speed  gap       level
+	{   0,     576,   8,  40,   0 }, // 2.25 pixels per tick
+	{  10,     704,   8,  48,   0 },
+	{  20,     832,   8,  48,   1 },
+	{  30,     960,  12,  56,   1 },
+	{  40,    1088,  12,  56,   2 },
+	{  50,    1216,  16,  64,   2 },
+	{  60,    1344,  16,  64,   2 },
+	{  80,    1536,  20,  72,   3 },
+	{ 100,    1792,  24,  80,   3 },
+	{ 130,    2176,  24,  88,   3 },
+	{ 160,    2560,  32,  96,   3 },
+	{ 200,    3072,  32,  96,   3 }, // 12 pixels per tick from here on
+};
+
+// The rules the game is played by on the ChipKIT. Its tables are filled in by build_game_rules().
+GameRules game_rules = {
+	JUMP_VELOCITY, GRAVITY,
+	obstacle_archetypes, NUM_OBSTACLE_ARCHETYPES,
+	difficulty_schedule, NUM_DIFFICULTY_BANDS,
+};
+
+// Pre-rendered static background (ground, labels, highscore and score) for the game screen
+uint8_t hud_layer[4][128] __attribute__((aligned(4)));
+
+// What update_display() last drew on top of hud_layer, so the next frame only redraws what changed
+const Sprite *drawn_character;
+int drawn_character_x;
+int drawn_character_y;
+const Sprite *drawn_obstacle;
+int drawn_obstacle_x;
+int drawn_obstacle_y;
+uint32_t drawn_score_bcd;
+const Sprite *drawn_ghost; // 0 if no ghost is drawn
+int drawn_ghost_x;
+int drawn_ghost_y;
+int full_redraw; // The whole frame has to be drawn from hud_layer
 
 
 /**
  * @brief Draws the ground on the screen.
- * 
+ *
  * This function fills a rectangle on the screen to represent the ground.
  * The rectangle starts at coordinates (0, 31) and has a width of 128 pixels
  * and a height of 1 pixel.
@@ -84,259 +108,702 @@ void draw_ground(void) {
 
 /**
  * @brief Draws the obstacles on the screen.
- 
- * The width of the obstacle is adjusted if it exceeds the screen width.
+
+ * Parts of the obstacle outside the screen are clipped by draw_image().
+ *
+ * @param game The game to draw.
+ */
+void draw_obstacles(const GameContext *game) {
+	draw_image(game->obstacle_x, game->obstacle_y, game->obstacle);
+}
+
+/**
+ * @brief Advances the running animation of the character and returns the frame to show.
+ *
+ * The character alternates between the two frames of its animation every 5 frames.
+ * If the action is RUNNING, the animation is dino_run (dino1 and dino2).
+ * If the action is DUCKING, the animation is dino_duck (dino_ducking1 and dino_ducking2).
+ *
+ * @param game The game whose character is animated.
+ * @return The index of the frame in the character's animation.
  */
-void draw_obstacles(void) {
-	int width = obstacle_width;
+int next_character_frame(GameContext *game) {
+	int frame = game->dino_frames_passed <= 5 ? 0 : 1;
 
-	if (obstacle_x + obstacle_width > 128) {
-		width = 128 - obstacle_x;
+	game->dino_frames_passed++;
+	if(game->dino_frames_passed >= 10) {
+		game->dino_frames_passed = 0;
 	}
 
-	draw_image(obstacle_x, obstacle_y, width, obstacle_height, obstacle);
+	return frame;
 }
 
 /**
- * @brief Draws the character on the screen based on the current action and animation frames.
-
- * The character image is selected based on the action and the number of frames passed.
- * If the action is RUNNING, the character image alternates between dino1 and dino2 every 5 frames (running animation).
- * If the action is DUCKING, the character image alternates between dino_ducking1 and dino_ducking2 every 5 frames (ducking and running).
- * The character's position and dimensions are passed to the draw_image function to draw the image on the screen.
+ * @brief Advances the character's animation and picks the sprite it is shown (and hit) with.
+ *
+ * @param game The game whose character is animated.
  */
-void draw_character(void) {
-	const uint8_t *image;
-
-	switch(action) {
-	case RUNNING:
-		if(dino_frames_passed <= 5) {
-			image = dino1;
-			dino_frames_passed++;
-		} else {
-			image = dino2;
-			dino_frames_passed++;
-			if(dino_frames_passed >= 10) {
-				dino_frames_passed = 0;
-			}
-		}
-		break;
+void animate_character(GameContext *game) {
+	game->character_animation = game->action == DUCKING ? &dino_duck : &dino_run;
+	game->character_frame = next_character_frame(game);
+	game->character = game->character_animation->frames[game->character_frame];
+}
 
-	case DUCKING:
-		if(dino_frames_passed <= 5) {
-			image = dino_ducking1;
-			dino_frames_passed++;
-		} else {
-			image = dino_ducking2;
-			dino_frames_passed++;
-			if(dino_frames_passed >= 10) {
-				dino_frames_passed = 0;
-			}
-		}
-		break;
-	
-	default:
-		break;
+/**
+ * @brief Checks whether two rectangles cover any of the same columns within the same pages.
+ *
+ * Drawing is restored page by page, so rectangles that share a column and a page
+ * can erase each other even if their pixels do not overlap.
+ */
+int rects_share_pages(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh) {
+	if(ax >= bx + bw || bx >= ax + aw) {
+		return 0;
 	}
+	return (ay >> 3) <= ((by + bh - 1) >> 3) && (by >> 3) <= ((ay + ah - 1) >> 3);
+}
+
+/**
+ * @brief Checks whether a jump can be started or extended.
+ *
+ * Holding the jump button keeps restarting the jump while the dino is still rising
+ * (or standing) and below JUMP_CEILING, so a held jump goes higher than a tapped one.
+ *
+ * @param y_q8 The top of the dino, in 1/256 pixels.
+ * @param velocity The vertical velocity of the dino, in 1/256 pixels per tick.
+ * @return 1 if pressing jump now sets the jump velocity, 0 otherwise.
+ */
+int can_jump(int32_t y_q8, int velocity) {
+	return y_q8 > (JUMP_CEILING << 8) && velocity <= 0;
+}
 
-	draw_image(character_x, (int)character_y, character_width, character_height, image);
+/**
+ * @brief Moves a body one tick under gravity, stopping it when it reaches the ground.
+ *
+ * @param y_q8 The top of the body, in 1/256 pixels.
+ * @param velocity The vertical velocity of the body, in 1/256 pixels per tick.
+ * @param ground_q8 The top of the body when it stands on the ground, in 1/256 pixels.
+ * @param gravity The acceleration, in 1/256 pixels per tick per tick.
+ */
+void apply_gravity(int32_t *y_q8, int *velocity, int32_t ground_q8, int gravity) {
+	*velocity += gravity;
+	if(*y_q8 + *velocity > ground_q8) {
+		*y_q8 = ground_q8;
+		*velocity = 0;
+	} else {
+		*y_q8 += *velocity;
+	}
 }
 
 /**
  * @brief Moves the character based on button presses and updates its position.
+ *
+ * The position and velocity are kept in fixed point, so the jump follows
+ * exactly the trajectories precomputed by build_jump_arcs().
+ *
+ * @param game The game whose character is moved.
+ * @param buttons The buttons held down this tick, as returned by getbtns().
  */
-void move_character() {
+void move_character(GameContext *game, int buttons) {
 	// check for button presses
-	if(getbtns() == BTN4 && character_y > 10 && y_velocity <= 0) { // BTN4
-		y_velocity = JUMP_VELOCITY;
-		action = RUNNING;
-	} else if (getbtns() == BTN3 && character_y == GROUND_Y - character_height) { // BTN3
-		character_height = DINO_DUCKING_HEIGHT;
-		character_width = DINO_DUCKING_WIDTH;
-		character_y = 31 - DINO_DUCKING_HEIGHT;
-		action = DUCKING;
-	} else if (!(getbtns() == BTN3) && character_height == DINO_DUCKING_HEIGHT) {
-		character_height = DINO_STANDING_HEIGHT;
-		character_width = DINO_STANDING_WIDTH;
-		action = RUNNING;
+	if(buttons == BTN4 && can_jump(game->character_y_q8, game->y_velocity)) { // BTN4
+		game->y_velocity = game->rules->jump_velocity;
+		game->action = RUNNING;
+	} else if (buttons == BTN3 && game->character_y == GROUND_Y - game->character_height) { // BTN3
+		game->character_height = DINO_DUCKING1_HEIGHT;
+		game->character_y_q8 = (GROUND_Y - DINO_DUCKING1_HEIGHT) << 8;
+		game->action = DUCKING;
+	} else if (buttons != BTN3 && game->character_height == DINO_DUCKING1_HEIGHT) {
+		game->character_height = DINO1_HEIGHT;
+		game->action = RUNNING;
 	}
 
 	// Update the character's y position
-	y_velocity += GRAVITY;
-	if(character_y + y_velocity > GROUND_Y - character_height) {
-		character_y = GROUND_Y - character_height;
-		y_velocity = 0;
+	apply_gravity(&game->character_y_q8, &game->y_velocity, (GROUND_Y - game->character_height) << 8, game->rules->gravity);
+	game->character_y = game->character_y_q8 >> 8;
+}
+
+/**
+ * @brief Checks whether two sprites have any set pixels in common.
+ *
+ * Sprites whose bounding boxes do not overlap are rejected right away. Otherwise the
+ * collision masks of only the overlapping columns are compared: the mask of the lower
+ * sprite is shifted up to the rows of the upper one and the two are ANDed, one word
+ * per column. Sprites without a collision mask collide with their bounding box.
+ *
+ * @param ax The x-coordinate of the top-left corner of the first sprite.
+ * @param ay The y-coordinate of the top-left corner of the first sprite.
+ * @param a The first sprite.
+ * @param bx The x-coordinate of the top-left corner of the second sprite.
+ * @param by The y-coordinate of the top-left corner of the second sprite.
+ * @param b The second sprite.
+ * @return 1 if the sprites overlap, 0 otherwise.
+ */
+int sprites_collide(int ax, int ay, const Sprite *a, int bx, int by, const Sprite *b) {
+	int x0 = ax > bx ? ax : bx;
+	int x1 = ax + a->width < bx + b->width ? ax + a->width : bx + b->width;
+
+	if(x0 >= x1 || ay >= by + b->height || by >= ay + a->height) {
+		return 0;
+	}
+	if(!a->mask || !b->mask) {
+		return 1;
+	}
+
+	const uint32_t *mask_a = a->mask + (x0 - ax);
+	const uint32_t *mask_b = b->mask + (x0 - bx);
+	int count = x1 - x0;
+	int i;
+
+	if(ay <= by) {
+		int shift = by - ay;
+		for(i = 0; i < count; i++) {
+			if(mask_a[i] & (mask_b[i] << shift)) {
+				return 1;
+			}
+		}
 	} else {
-		character_y += y_velocity;
+		int shift = ay - by;
+		for(i = 0; i < count; i++) {
+			if((mask_a[i] << shift) & mask_b[i]) {
+				return 1;
+			}
+		}
 	}
+	return 0;
 }
 
 /**
- * @brief Checks if the character is colliding with the obstacle.
- * 
- * If there is a collision, it calls insert_score().
+ * @brief Checks whether two moving sprites have any set pixels in common anywhere along their moves.
+ *
+ * The first sprite moves vertically by dy rows and the second horizontally by dx columns,
+ * both from the positions given. The boxes covering everything both sprites swept through
+ * are tested first, which rejects almost every call. Otherwise the moves are split into
+ * sub-steps of at most SWEEP_STEP pixels, and the sprites are compared pixel by pixel at
+ * every sub-step, so only fast moves cost more than one test. The start positions are not tested.
+ *
+ * @param ax The x-coordinate of the first sprite.
+ * @param ay The y-coordinate the first sprite moves from.
+ * @param dy How far the first sprite moves down (up if negative).
+ * @param a The first sprite.
+ * @param bx The x-coordinate the second sprite moves from.
+ * @param by The y-coordinate of the second sprite.
+ * @param dx How far the second sprite moves right, never positive.
+ * @param b The second sprite.
+ * @return 1 if the sprites overlap at any sub-step, 0 otherwise.
  */
-void check_collision() {
-	// Check if the character is colliding with the obstacle
-	if(character_x + character_width - 3 >= obstacle_x + 3 && character_x + 3 <= obstacle_x + obstacle_width - 3) { // Check if the character is in the x range of the obstacle
-		if(obstacle_y + obstacle_height >= character_y && obstacle_y <= character_y + character_height) { // Check if the character is in the y range of the obstacle
-			insert_score(score);
+int sprites_collide_swept(int ax, int ay, int dy, const Sprite *a, int bx, int by, int dx, const Sprite *b) {
+	int fall = dy < 0 ? -dy : dy;
+	int top = dy < 0 ? ay + dy : ay;
+
+	if(ax >= bx + b->width || bx + dx >= ax + a->width || top >= by + b->height || by >= top + fall + a->height) {
+		return 0;
+	}
+
+	int distance = -dx > fall ? -dx : fall;
+	int steps = distance > SWEEP_STEP ? (distance + SWEEP_STEP - 1) / SWEEP_STEP : 1;
+	int i;
+
+	for(i = 1; i <= steps; i++) {
+		if(sprites_collide(ax, ay + dy * i / steps, a, bx + dx * i / steps, by, b)) {
+			return 1;
 		}
 	}
+	return 0;
 }
 
 /**
- * @brief Generates a seemingly random integer based on the value of TMR3 and the score.
- * 
- * @return The generated random integer.
+ * @brief Checks if the character is colliding with the obstacle anywhere along their moves this tick.
+ *
+ * At high speeds the obstacle moves further than the width of both sprites in one tick,
+ * so testing only the end positions would let it pass straight through the character.
+ * Both moves are swept with sprites_collide_swept(), using the frames shown this tick.
+ *
+ * Only a move through the air is swept vertically. Ducking or standing up changes the
+ * height of the character in place, so its y jumps without it passing through the rows
+ * in between, and only its end position is tested.
+ *
+ * @param game The game to check.
+ * @return 1 if the character hit the obstacle, 0 otherwise.
  */
-int random_int() {
-	int random = (TMR3 + score) % 4;
-	TMR3 = 0;
-	return random;
+static int check_collision(const GameContext *game) {
+	int from_x = game->previous_obstacle_x;
+	int from_y = game->previous_character_y;
+
+	if(game->obstacle_x > from_x) { // A new obstacle was spawned, it did not sweep anything
+		from_x = game->obstacle_x;
+	}
+	if(game->character_height != game->previous_character_height) { // Ducked or stood up, it did not sweep anything
+		from_y = game->character_y;
+	}
+
+	return sprites_collide_swept(game->character_x, from_y, game->character_y - from_y, game->character,
+		from_x, game->obstacle_y, game->obstacle_x - from_x, game->obstacle);
 }
 
 /**
- * @brief spawns an obstacle in the game.
- * 
- * This function spawns an obstacle in the game. The type of obstacle spawned 
- * is determined randomly. The obstacle's position, height, and width are set 
- * based on the type of obstacle.
+ * @brief Increments a packed BCD number by one without any division.
+ *
+ * Adds 6 to every digit in advance so that decimal carries propagate as binary
+ * carries, then subtracts the 6 again from every digit that did not carry.
+ *
+ * @param bcd The packed BCD number to increment.
+ * @return bcd + 1, as packed BCD.
  */
-void spawn_obstacle() {
-	obstacle_x = OBSTACLE_SPAWN_X;
-
-	switch(random_int()) {
-	case 0: // Spawn a small obstacle on the ground
-		obstacle = cactus_small;
-		obstacle_y = GROUND_Y - SMALL_CACTUS_HEIGHT;
-		obstacle_height = SMALL_CACTUS_HEIGHT;
-		obstacle_width = SMALL_CACTUS_WIDTH;
-		break;
-	
-	case 1: // Spawn a big obstacle
-		obstacle = cactus_big;
-		obstacle_y = GROUND_Y - BIG_CACTUS_HEIGHT;
-		obstacle_height = BIG_CACTUS_HEIGHT;
-		obstacle_width = BIG_CACTUS_WIDTH;
-		break;
-	
-	case 2: // Spawn a bird at low height
-		obstacle = bird1;
-		obstacle_y = MID_AIR_Y - BIRD_HEIGHT;
-		obstacle_height = BIRD_HEIGHT;
-		obstacle_width = BIRD_WIDTH;
-		break;	
-
-	case 3: // Spawn a bird at high height
-		obstacle = bird1;
-		obstacle_y = HIGH_AIR_Y - BIRD_HEIGHT;
-		obstacle_height = BIRD_HEIGHT;
-		obstacle_width = BIRD_WIDTH;
-		break;
-
-	default:
-		break;
-	}
+uint32_t bcd_increment(uint32_t bcd) {
+	uint32_t biased = bcd + 0x06666666;
+	uint32_t sum = biased + 1;
+	uint32_t no_carry = ~(sum ^ biased ^ 1) & 0x11111110;
+	return sum - ((no_carry >> 2) | (no_carry >> 3));
 }
 
 /**
- * @brief Moves the obstacle in the game.
- 
- * The speed of the obstacle is determined by the score.
- * If the obstacle is off the screen, a new obstacle is spawned and the score is incremented.
- * update_LEDs() is called to visualize the score.
+ * @brief Records the trajectories of a tapped and a held jump from the ground.
+ *
+ * The jumps are played through can_jump() and apply_gravity(), the same code that
+ * moves the character, so the tables match the game exactly.
+ *
+ * @param rules The rules whose jump velocity and gravity are used, and whose arcs are filled in.
  */
-void move_obstacle() {	
-	speed = 0.05f * score + 2.0;
-	
-	if(obstacle_x + obstacle_width > 0) {
-		obstacle_x-=speed;
-
-		// Animate the bird
-		if(obstacle == bird1 && bird_frames_passed < 3) {
-			bird_frames_passed++;
-
-			if(bird_frames_passed == 3) {
-				obstacle = bird2;
-				bird_frames_passed = 0;
+void build_jump_arcs(GameRules *rules) {
+	JumpArc *jump_arcs = rules->jump_arcs;
+	int32_t ground = (GROUND_Y - DINO1_HEIGHT) << 8;
+	int arc;
+
+	for(arc = 0; arc < NUM_JUMP_ARCS; arc++) {
+		int32_t y = ground;
+		int velocity = 0;
+		int tick = 0;
+
+		do {
+			if((tick == 0 || arc == JUMP_HELD) && can_jump(y, velocity)) {
+				velocity = rules->jump_velocity;
 			}
-		} else if(obstacle == bird2 && bird_frames_passed < 3){
-			bird_frames_passed++;
+			apply_gravity(&y, &velocity, ground, rules->gravity);
+			jump_arcs[arc].rise[tick] = (ground >> 8) - (y >> 8);
+			tick++;
+		} while(y != ground && tick < MAX_JUMP_TICKS);
+
+		jump_arcs[arc].ticks = tick;
+	}
+}
 
-			if(bird_frames_passed == 3) {
-				obstacle = bird1;
-				bird_frames_passed = 0;
+/**
+ * @brief Works out how an archetype can be cleared: by ducking, or by which jumps and when.
+ *
+ * The dino clears a jumpable obstacle while it is at least as many pixels above the ground
+ * as the top of the obstacle is. The jump arcs only rise and then fall, so there is a single
+ * stretch of ticks where that holds.
+ */
+void build_clearance(const JumpArc *jump_arcs, const ObstacleArchetype *type, ObstacleClearance *clearance) {
+	int top = type->bottom - type->sprite->height;
+	int need = GROUND_Y - top;
+	int arc, tick;
+
+	clearance->duck = type->bottom <= GROUND_Y - DINO_DUCKING1_HEIGHT;
+
+	for(arc = 0; arc < NUM_JUMP_ARCS; arc++) {
+		clearance->lead[arc] = 0;
+		clearance->airtime[arc] = 0;
+
+		for(tick = 0; tick < jump_arcs[arc].ticks; tick++) {
+			if(jump_arcs[arc].rise[tick] >= need) {
+				if(!clearance->airtime[arc]) {
+					clearance->lead[arc] = tick + 1;
+				}
+				clearance->airtime[arc]++;
 			}
 		}
+	}
+}
+
+/**
+ * @brief Builds the tables of a set of rules that spawn_obstacle() uses: the alias tables, the jump arcs and the clearances.
+ *
+ * Called once at start-up (and by the host tools for every set of rules they try), so spawning
+ * never has to look at the weights or simulate a jump. The tables are only read afterwards,
+ * so all games played by the same rules share them. A difficulty level whose weights are all
+ * zero gets an alias table with no entries, and the rules cannot be played at that level.
+ *
+ * @param rules The rules to build the tables of. Everything but the tables must be set.
+ */
+void build_game_rules(GameRules *rules) {
+	uint8_t weights[MAX_ARCHETYPES];
+	int level, i;
+
+	for(level = 0; level < DIFFICULTY_LEVELS; level++) {
+		for(i = 0; i < rules->archetype_count; i++) {
+			weights[i] = rules->archetypes[i].weights[level];
+		}
+		build_alias_table(&rules->obstacle_tables[level], weights, rules->archetype_count);
+	}
+
+	build_jump_arcs(rules);
+	for(i = 0; i < rules->archetype_count; i++) {
+		build_clearance(rules->jump_arcs, &rules->archetypes[i], &rules->clearance[i]);
+	}
+}
+
+/**
+ * @brief Returns the jump that clears an obstacle at a speed and lands soonest, or -1 if none does.
+ *
+ * The dino overlaps the obstacle horizontally while it moves the width of both, and
+ * collisions are swept between ticks, so the dino has to stay above the obstacle for
+ * that distance measured from the first to the last tick it is high enough.
+ */
+int clearing_jump(const ObstacleClearance *clearance, int width, int speed) {
+	int arc;
+
+	for(arc = 0; arc < NUM_JUMP_ARCS; arc++) {
+		if(clearance->airtime[arc] && (clearance->airtime[arc] - 1) * speed >= (width + DINO1_WIDTH) << 8) {
+			return arc;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Moves on to the band of the difficulty schedule that the score has reached.
+ *
+ * Only called when the score changes, so every other tick the difficulty is just
+ * read through the difficulty pointer.
+ *
+ * @param game The game whose difficulty is updated.
+ */
+void update_difficulty(GameContext *game) {
+	const DifficultyBand *last = &game->rules->schedule[game->rules->band_count - 1];
+
+	while(game->difficulty < last && game->score >= game->difficulty[1].min_score) {
+		game->difficulty++;
+	}
+}
+
+/**
+ * @brief spawns an obstacle in the game.
+ *
+ * This function spawns an obstacle in the game. The archetype of the obstacle is drawn
+ * from the alias table of the current difficulty level, using the spawn stream of the
+ * seeded generator. Archetypes that cannot be cleared at their speed, by ducking or by
+ * any jump, are drawn again. This is a lookup in the clearance tables, no jump is simulated.
+ * If none of the draws can be cleared the spawn is rejected: the first archetype is left
+ * off the left edge of the screen, where it is neither drawn nor hit, and the spawn is
+ * tried again on the next tick.
+ *
+ * The obstacle's sprite and position are set from the archetype.
+ * It starts a random gap (within the limits of the difficulty band) beyond the right edge.
+ * The gap is widened if the dino, still landing from the previous obstacle, could not get
+ * back on the ground and (for a jump) high enough before the obstacle reaches it.
+ * Its speed for the whole way across is worked out once here.
+ *
+ * @param game The game to spawn the obstacle in.
+ * @return 1 if an obstacle was spawned, 0 if the spawn was rejected.
+ */
+int spawn_obstacle(GameContext *game) {
+	const GameRules *rules = game->rules;
+	const ObstacleArchetype *obstacle_archetypes = rules->archetypes;
+	const ObstacleClearance *obstacle_clearance = rules->clearance;
+	const DifficultyBand *difficulty = game->difficulty;
+	int attempt, type = 0, arc = -1;
+	int speed;
+
+	for(attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+		type = alias_sample(&rules->obstacle_tables[difficulty->level], &game->spawn_rng);
+		speed = (difficulty->speed * obstacle_archetypes[type].velocity) >> 8;
+		if(obstacle_clearance[type].duck) {
+			break;
+		}
+		arc = clearing_jump(&obstacle_clearance[type], obstacle_archetypes[type].sprite->width, speed);
+		if(arc >= 0) {
+			break;
+		}
+	}
+	if(attempt == SPAWN_ATTEMPTS) {
+		const Sprite *parked = obstacle_archetypes[0].sprite;
+		game->obstacle_type = &obstacle_archetypes[0];
+		game->obstacle = parked;
+		game->obstacle_frame = 0;
+		game->obstacle_ticks = 0;
+		game->obstacle_speed = 0;
+		game->obstacle_x_q8 = -(parked->width << 8);
+		game->obstacle_x = -parked->width;
+		game->obstacle_y = obstacle_archetypes[0].bottom - parked->height;
+		return 0;
+	}
+
+	const ObstacleArchetype *obstacle_type = &obstacle_archetypes[type];
+	const Sprite *obstacle = obstacle_type->sprite;
+	game->obstacle_type = obstacle_type;
+	game->obstacle = obstacle;
+	game->obstacle_frame = 0;
+	game->obstacle_ticks = 0;
+	game->obstacle_speed = speed;
+
+	const ObstacleClearance *clearance = &obstacle_clearance[type];
+	int duck = clearance->duck;
+	int lead = duck ? 1 : clearance->lead[arc];
+	int front = game->character_x + (duck ? DINO_DUCKING1_WIDTH : DINO1_WIDTH);
+
+	int gap = difficulty->min_gap + rng_below(&game->spawn_rng, difficulty->max_gap - difficulty->min_gap + 1);
+	int needed = ((((game->recovery_ticks + lead) * speed) + 255) >> 8) + front - OBSTACLE_SPAWN_X;
+	if(gap < needed) {
+		gap = needed;
+	}
+
+	// Jumping over this obstacle at the last moment, the dino lands this long after it has left
+	if(duck) {
+		game->recovery_ticks = 0;
 	} else {
-		if(obstacle_x + obstacle_width <= 1) {
-			spawn_obstacle();
-			score++;	
-			update_LEDs();
+		game->recovery_ticks = rules->jump_arcs[arc].ticks - lead - ((front + obstacle->width) << 8) / speed;
+		if(game->recovery_ticks < 0) {
+			game->recovery_ticks = 0;
 		}
 	}
+
+	game->obstacle_x_q8 = (OBSTACLE_SPAWN_X + gap) << 8;
+	game->obstacle_x = game->obstacle_x_q8 >> 8;
+	game->obstacle_y = obstacle_type->bottom - obstacle->height;
+	return 1;
 }
 
 /**
- * @brief Resets the game state to its initial values.
- * 
- * This function resets the character's position, height, width, velocity, speed, score, and action.
- * It also calls the spawn_obstacle() function to generate a new obstacle and updates the LEDs.
+ * @brief Scores the obstacle that has left the screen and spawns the next one.
+ *
+ * The score is incremented and the difficulty schedule is advanced. The BCD copy of the
+ * score, which the display and the LEDs show, is incremented along with it. While a
+ * rejected spawn is retried the score stays the same.
+ *
+ * @param game The game whose obstacle has left the screen.
  */
-void reset_game(void) {
-	character_x = 10;
-	character_y = GROUND_Y - DINO_STANDING_HEIGHT;
-	character_height = DINO_STANDING_HEIGHT;
-	character_width = DINO_STANDING_WIDTH;
-	y_velocity = 0;
-	speed = 1;
-	score = 0;
-	action = RUNNING;
-	spawn_obstacle();
-	update_LEDs();
+void pass_obstacle(GameContext *game) {
+	if(!game->spawn_pending) {
+		game->score++;
+		game->score_bcd = bcd_increment(game->score_bcd);
+		update_difficulty(game);
+	}
+	game->spawn_pending = !spawn_obstacle(game);
 }
 
 /**
- * @brief draws everything on the screen.
- * 
- * Updates the display by clearing all pixels, drawing the ground, character, obstacles,
- * score, and highscore, and displaying the objects.
+ * @brief Moves the obstacle in the game.
+
+ * The obstacle moves in fixed point at the speed set when it was spawned.
+ * Animated obstacles step to their next frame every animation period.
+ * If the obstacle is off the screen it is passed, see pass_obstacle().
+ *
+ * @param game The game whose obstacle is moved.
+ */
+static void move_obstacle(GameContext *game) {
+	if(game->obstacle_x + game->obstacle->width > 0) {
+		game->obstacle_x_q8 -= game->obstacle_speed;
+		game->obstacle_x = game->obstacle_x_q8 >> 8;
+
+		// Animate the obstacle
+		const ObstacleArchetype *type = game->obstacle_type;
+		if(type->animation && ++game->obstacle_ticks == type->animation_period) {
+			game->obstacle_ticks = 0;
+			game->obstacle_frame = (game->obstacle_frame + 1) % type->animation->frame_count;
+			game->obstacle = type->animation->frames[game->obstacle_frame];
+		}
+	} else {
+		pass_obstacle(game);
+	}
+}
+
+/**
+ * @brief Renders the static parts of the game screen into hud_layer.
+ *
+ * The ground, the "score: " and "highscore: " labels and the highscore digits
+ * do not change during a run, so they are drawn once when a run starts.
+ * The score digits also live in this layer and are patched by update_display() when they change.
+ * Each frame then starts from a copy of this layer instead of a cleared screen.
+ *
+ * @param game The game that is starting.
  */
-void update_display(void) {
+void build_hud_layer(const GameContext *game) {
 	clear_all_pixels();
 
 	draw_ground();
 
-	draw_character();
-
-	draw_obstacles();
-
 	draw_string(0, 0, "score: ");
 
-	draw_number(35, 0, score);
-
 	draw_string(50, 0, "highscore: ");
-	
+
 	draw_number(110, 0, highscore);
 
+	store_layer(hud_layer);
+
+	draw_bcd(hud_layer, SCORE_X, SCORE_Y, game->score_bcd, 0xFFFFFFFF);
+	drawn_score_bcd = game->score_bcd;
+}
+
+/**
+ * @brief Resets a game to its initial state.
+ *
+ * This function resets the character's position, height, velocity, difficulty, score, action
+ * and animations, and seeds the random stream of the spawns. Everything that happens in the run follows from
+ * the seed and the buttons passed to update_game(), so a run can be reproduced by passing the
+ * same seed again. It also calls the spawn_obstacle() function to generate a new obstacle.
+ *
+ * @param game The game to reset.
+ * @param rules The rules to play by, built by build_game_rules(). They are not copied.
+ * @param seed The seed of the run.
+ */
+void reset_game(GameContext *game, const GameRules *rules, uint32_t seed) {
+	game->rules = rules;
+	game->seed = seed;
+	rng_seed(&game->spawn_rng, seed, RNG_SPAWN_STREAM);
+
+	game->character_x = 10;
+	game->character_y_q8 = (GROUND_Y - DINO1_HEIGHT) << 8;
+	game->character_y = GROUND_Y - DINO1_HEIGHT;
+	game->character_height = DINO1_HEIGHT;
+	game->y_velocity = 0;
+	game->action = RUNNING;
+	game->character_animation = &dino_run;
+	game->character_frame = 0;
+	game->character = &dino1;
+	game->dino_frames_passed = 0;
+
+	game->score = 0;
+	game->score_bcd = 0;
+	game->difficulty = rules->schedule;
+	game->recovery_ticks = 0;
+	game->game_over = 0;
+
+	game->spawn_pending = !spawn_obstacle(game);
+	game->previous_obstacle_x = game->obstacle_x;
+	game->previous_character_y = game->character_y;
+	game->previous_character_height = game->character_height;
+}
+
+/**
+ * @brief Prepares the screen for drawing a game that has just been reset.
+ *
+ * Renders the static background layer for the run and requests a full redraw.
+ *
+ * @param game The game that will be drawn.
+ */
+void reset_display(const GameContext *game) {
+	build_hud_layer(game);
+	drawn_ghost = 0;
+	full_redraw = 1;
+}
+
+/**
+ * @brief draws everything on the screen.
+ *
+ * After a reset the frame starts from the pre-rendered background layer (which already
+ * contains the score). After that only what changed is redrawn: changed score digits are
+ * patched into the layer, the obstacle's and the score's old areas are restored from the
+ * layer, and the character is either left alone, stepped to its next animation frame by
+ * redrawing only the changed columns, or restored and redrawn if it moved or the restored
+ * obstacle area touched it. Only the changed areas are marked dirty, so display_objects()
+ * sends only those to the display.
+ *
+ * A ghost, the character of another game played alongside, is drawn dithered on top of
+ * everything else until its game is over. Its old area is restored first, like the
+ * obstacle's, so it costs about as much to draw as the character.
+ *
+ * @param game The game to draw.
+ * @param ghost The game whose character is drawn as the ghost, or 0 for none.
+ */
+void update_display(const GameContext *game, const GameContext *ghost) {
+	const Animation *animation = game->character_animation;
+	int frame = game->character_frame;
+	const Sprite *image = game->character;
+	int x = game->character_x;
+	int y = game->character_y;
+	int redraw_character = 1;
+
+	if(game->score_bcd != drawn_score_bcd) {
+		draw_bcd(hud_layer, SCORE_X, SCORE_Y, game->score_bcd, drawn_score_bcd);
+	}
+
+	if(full_redraw) {
+		load_layer(hud_layer);
+		full_redraw = 0;
+	} else {
+		int touched = rects_share_pages(drawn_obstacle_x, drawn_obstacle_y, drawn_obstacle->width, drawn_obstacle->height,
+			drawn_character_x, drawn_character_y, drawn_character->width, drawn_character->height);
+
+		if(game->score_bcd != drawn_score_bcd) {
+			restore_rect(hud_layer, SCORE_X, SCORE_Y, SCORE_DIGITS * (DIGIT_WIDTH + 1), FONT_HEIGHT);
+			touched |= rects_share_pages(SCORE_X, SCORE_Y, SCORE_DIGITS * (DIGIT_WIDTH + 1), FONT_HEIGHT,
+				drawn_character_x, drawn_character_y, drawn_character->width, drawn_character->height);
+		}
+
+		restore_rect(hud_layer, drawn_obstacle_x, drawn_obstacle_y, drawn_obstacle->width, drawn_obstacle->height);
+
+		if(drawn_ghost) {
+			restore_rect(hud_layer, drawn_ghost_x, drawn_ghost_y, drawn_ghost->width, drawn_ghost->height);
+			touched |= rects_share_pages(drawn_ghost_x, drawn_ghost_y, drawn_ghost->width, drawn_ghost->height,
+				drawn_character_x, drawn_character_y, drawn_character->width, drawn_character->height);
+		}
+
+		int previous = animation->frames[(frame + animation->frame_count - 1) % animation->frame_count] == drawn_character;
+
+		if(!touched && x == drawn_character_x && y == drawn_character_y && (image == drawn_character || previous)) {
+			if(image != drawn_character) {
+				draw_animation_step(hud_layer, x, y, animation, frame);
+			}
+			redraw_character = 0;
+		} else {
+			restore_rect(hud_layer, drawn_character_x, drawn_character_y, drawn_character->width, drawn_character->height);
+		}
+	}
+
+	draw_obstacles(game);
+
+	if(redraw_character) {
+		draw_image(x, y, image);
+	}
+
+	drawn_ghost = 0;
+	if(ghost && !ghost->game_over) {
+		draw_dithered(ghost->character_x, ghost->character_y, ghost->character);
+		drawn_ghost = ghost->character;
+		drawn_ghost_x = ghost->character_x;
+		drawn_ghost_y = ghost->character_y;
+	}
+
+	drawn_character = image;
+	drawn_character_x = x;
+	drawn_character_y = y;
+	drawn_obstacle = game->obstacle;
+	drawn_obstacle_x = game->obstacle_x;
+	drawn_obstacle_y = game->obstacle_y;
+	drawn_score_bcd = game->score_bcd;
+
 	display_objects();
 }
 
 /**
  * @brief Updates the game state by moving the character, moving the obstacle, and checking for collisions.
- * 
+ *
  * This function is responsible for updating the game state by performing the following actions:
  * - Moving the character.
+ * - Advancing the character's animation.
  * - Moving the obstacle.
- * - Checking for collisions between the character and the obstacle.
- * 
- * @return void
+ * - Checking for collisions between the character and the obstacle along their moves.
+ *
+ * A collision sets game_over; what happens next (entering the score) is up to the caller.
+ * A game that is over is not updated any more.
+ *
+ * @param game The game to update.
+ * @param buttons The buttons held down this tick, as returned by getbtns().
  */
-void update_game(void) {
-	move_character();
+void update_game(GameContext *game, int buttons) {
+	if(game->game_over) {
+		return;
+	}
 
-	move_obstacle();
+	game->previous_obstacle_x = game->obstacle_x;
+	game->previous_character_y = game->character_y;
+	game->previous_character_height = game->character_height;
 
-	check_collision();
-}
\ No newline at end of file
+	move_character(game, buttons);
+	animate_character(game);
+
+	move_obstacle(game);
+
+	game->game_over = check_collision(game);
+}
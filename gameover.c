@@ -14,22 +14,22 @@
 #include <pic32mx.h> /* Declarations of system-specific addresses etc */
 #include "declare.h" /* Declatations for these labs */
 
-int highscore;
-int score;
-
 /**
  * @brief Draws the game over screen with the score and highscore.
  * 
  * This function clears all pixels on the display and then draws the game over message,
- * the player's score, the highscore, and the button instructions.
+ * the seed of the run (in hexadecimal, so the run can be reproduced), the player's score,
+ * the highscore, and the button instructions. BTN3 rewinds the run that just ended.
  */
 void draw_gameover() {
     clear_all_pixels();
-    draw_string(40, 0, "game over"); 
+    draw_string(0, 0, "game over");
+    draw_hex(80, 0, game.seed, 8);
     draw_string(0, 8, "your score: ");
-    draw_number(65, 8, score);
+    draw_number(65, 8, game.score);
     draw_string(0, 16, "highscore: ");
     draw_number(60, 16, highscore);
+    draw_string(80, 16, "btn3:rew");
     draw_string(0, 24, "btn4:start btn2:menu");
     display_objects();
 }
\ No newline at end of file
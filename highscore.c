@@ -3,7 +3,8 @@
  * @brief Implementation of highscore functionality.
  *
  * This file contains the implementation of functions related to highscore management.
- * It includes functions for reading and writing scores and initials to an EEPROM memory,
+ * It includes functions for reading and writing scores, initials and the replay of the
+ * top score to an EEPROM memory,
  * updating LEDs with the current score value, printing the leaderboard on the screen,
  * and inserting scores and initials into the leaderboard.
  *
@@ -22,8 +23,20 @@
 #include "declare.h"
 #include "stdbool.h"
 
+// Declare the I2C functions in i2c-func.c
+void i2c_idle();
+bool i2c_send(uint8_t data);
+uint8_t i2c_recv();
+void i2c_ack();
+void i2c_nack();
+void i2c_start();
+void i2c_restart();
+void i2c_stop();
+
+int highscore;
 int ledValue = 0;
 uint8_t leaderboard_scores[NUM_LEADERBOARD_ENTRIES];
+int leaderboard_index;
 
 // Initialize LEDs
 volatile int *porte = (volatile int *)0xbf886110;
@@ -33,6 +46,8 @@ volatile int *trise = (volatile int *)0xbf886100;
 #define EEPROM_READ 0xA1  // 1010 000 (1)
 #define SCORE_ADDRESS 0x0230 
 #define INITIALS_ADDRESS 0x0000
+#define REPLAY_ADDRESS 0x0400 // The replay of the top score, after the leaderboard
+#define EEPROM_PAGE_SIZE 64   // A write must not cross a page, or it wraps around within the page
 #define I2C_DELAY 500000 // Delay to allow the EEPROM to complete the write operation (minimum 5 ms)
 
 
@@ -121,15 +136,135 @@ void eeprom_write_byte(uint16_t address, uint8_t data) {
     delay(I2C_DELAY);
 }
 
+/**
+ * @brief Writes a block of bytes to the EEPROM, one page at a time.
+ *
+ * The EEPROM can write up to a page of bytes at once, but a write that crosses the end of
+ * a page wraps around to its start, so the block is split at every page boundary.
+ *
+ * @param address The memory address to write the first byte to.
+ * @param data The bytes to write.
+ * @param size The number of bytes to write.
+ */
+void eeprom_write_block(uint16_t address, const uint8_t *data, int size) {
+    while(size > 0) {
+        int count = EEPROM_PAGE_SIZE - (address % EEPROM_PAGE_SIZE);
+        if(count > size) {
+            count = size;
+        }
+
+        // Step 1: Send start condition
+        i2c_start();
+
+        // Step 2: Send EEPROM device address with RW-bit
+        i2c_send(EEPROM_WRITE);
+
+        // Step 3: Send the memory address of the first byte of the page
+        i2c_send((uint8_t)(address >> 8)); // MSB of address
+        i2c_send((uint8_t)(address & 0xFF)); // LSB of address
+
+        // Step 4: Send the bytes that go to this page
+        int i;
+        for(i = 0; i < count; i++) {
+            i2c_send(data[i]);
+        }
+
+        // Step 5: Send stop condition and let the EEPROM write the page
+        i2c_stop();
+        delay(I2C_DELAY);
+
+        address += count;
+        data += count;
+        size -= count;
+    }
+}
+
+/**
+ * @brief Reads a block of bytes from the EEPROM.
+ *
+ * Sequential reads are not limited to a page, so the block is read in one go.
+ *
+ * @param address The memory address of the first byte.
+ * @param data The array to store the bytes in.
+ * @param size The number of bytes to read, at least one.
+ */
+void eeprom_read_block(uint16_t address, uint8_t *data, int size) {
+    // Step 1: Send start condition
+    i2c_start();
+
+    // Step 2: Send EEPROM device address with RW-bit = 0
+    i2c_send(EEPROM_WRITE);
+
+    // Step 3: Send the memory address you want to read from
+    i2c_send((uint8_t)(address >> 8)); // MSB of address
+    i2c_send((uint8_t)(address & 0xFF)); // LSB of address
+
+    // Step 4: Send restart condition
+    i2c_restart();
+
+    // Step 5: Send EEPROM device address with read bit set again
+    i2c_send(EEPROM_READ);
+
+    // Step 6: Receive the data from the EEPROM, acknowledging all but the last byte
+    int i;
+    for(i = 0; i < size - 1; i++) {
+        data[i] = i2c_recv();
+        i2c_ack();
+    }
+    data[i] = i2c_recv();
+    i2c_nack();
+
+    // Step 7: Send stop condition
+    i2c_stop();
+}
+
+/**
+ * @brief Stores a replay in the EEPROM, after the leaderboard.
+ *
+ * Only the header and the runs that are used are written.
+ *
+ * @param replay The replay to store.
+ */
+void write_replay(const Replay *replay) {
+    uint8_t header[REPLAY_HEADER_BYTES];
+
+    replay_encode_header(replay, header);
+    eeprom_write_block(REPLAY_ADDRESS, header, REPLAY_HEADER_BYTES);
+    if(replay->length > 0) {
+        eeprom_write_block(REPLAY_ADDRESS + REPLAY_HEADER_BYTES, replay->runs, replay->length);
+    }
+}
+
+/**
+ * @brief Reads the replay stored in the EEPROM.
+ *
+ * @param replay The replay to read into.
+ * @return 1 if a replay was read, 0 if none has been stored yet.
+ */
+int read_replay(Replay *replay) {
+    uint8_t header[REPLAY_HEADER_BYTES];
+
+    eeprom_read_block(REPLAY_ADDRESS, header, REPLAY_HEADER_BYTES);
+    if(!replay_decode_header(replay, header)) {
+        return 0;
+    }
+    if(replay->length > 0) {
+        eeprom_read_block(REPLAY_ADDRESS + REPLAY_HEADER_BYTES, replay->runs, replay->length);
+    }
+    return 1;
+}
+
 /**
  * @brief Updates the LEDs with the current score value.
  * 
- * This function sets the value of the LEDs to the current score value.
+ * This function sets the value of the LEDs to the last two decimal digits of the score,
+ * taken straight from the BCD score counter (one digit per group of four LEDs).
  * 
+ * @param score_bcd The score as packed BCD.
  * @return None
  */
-void update_LEDs() {
-    ledValue = score;
+void update_LEDs(uint32_t score_bcd) {
+    ledValue = score_bcd & 0xFF;
 
     // Update the LEDs
     *porte = ledValue;
@@ -293,7 +428,7 @@ void read_leaderboard() {
  * The function uses the draw_number, substring, and draw_string functions to display the leaderboard entries.
  */
 void print_leaderboard() {
-    char initials[3];
+    char initials[INITIALS_LENGTH + 1];
     
     int i = 0;
     while(i < NUM_LEADERBOARD_ENTRIES) {
@@ -354,6 +489,7 @@ void insert_initials(char *initials, int index) {
  * the leaderboard, it will be inserted at the appropriate position and the
  * leaderboard will be updated accordingly. If the score is not higher than
  * any existing scores, the function will change the game state to GAME_OVER_STATE.
+ * A new top score is stored together with the replay of its run.
  *
  * @param score The score to be inserted into the leaderboard.
  */
@@ -372,6 +508,11 @@ void insert_score(uint8_t score) {
             leaderboard_scores[i] = score;
             leaderboard_index = i;
             write_multiple_scores(leaderboard_scores);
+            if(i == 0) { // Keep the replay of the new top score, it is the ghost from now on
+                write_replay(&replay);
+                best_replay = replay;
+                has_best_replay = 1;
+            }
             inserted = true;
             highscore = leaderboard_scores[0];
             change_state(ENTER_NAME_STATE);
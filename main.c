@@ -22,8 +22,85 @@
 #include <pic32mx.h> /* Declarations of system-specific addresses etc */
 #include "declare.h" /* Declatations for these labs */
 
+#define ATTRACT_IDLE_TICKS 300 // Ticks the menu is left alone before the autopilot starts playing
+#define SOAK_PAUSE_TICKS 60     // Ticks a soak test shows a screen before pressing a button on it
+#define SOAK_MIN_SCORE 10       // A soak run ends at a score from SOAK_MIN_SCORE ...
+#define SOAK_SCORE_RANGE 240    // ... to SOAK_MIN_SCORE + SOAK_SCORE_RANGE - 1, which the leaderboard can hold
+
 GameState currentState;
 int delay_counter;
+int idle_ticks; // Ticks since the state changed or, in the menu, a button was pressed
+GameContext game;
+Replay replay;
+ReplayCursor replay_cursor;
+
+// The top score's run, played back when asked for and as the ghost
+Replay best_replay;
+int has_best_replay;
+GameContext ghost;
+ReplayCursor ghost_cursor;
+int ghost_running; // The current run races the ghost
+
+// The last seconds of the run, and the tick shown while stepping through them
+RewindBuffer rewind_buffer;
+uint32_t rewind_tick;
+int rewind_held;      // Buttons held on the last tick, so that only new presses of BTN2 count
+int rewind_resumable; // The run was paused, not over, and can be played on from the tick shown
+
+// The autopilot playing the attract mode or a soak test, and the score the soak run ends at
+Autopilot pilot;
+int soak_score;
+
+#ifdef BENCH
+// The benchmark build times the drawing code on the CP0 Count register, which counts at
+// half the 80 MHz CPU clock, and sends the results over the UART
+const BenchClock board_clock = { read_count, 2, 1, 25, 1, 64, uart_puts };
+#endif
+
+/**
+ * @brief Picks the seed of a new run.
+ *
+ * Timer 3 runs freely, so its value depends on when the player pressed start.
+ * It is mixed with the previous seed so that two runs started at the same
+ * timer value still differ.
+ *
+ * @return The seed for the new run.
+ */
+uint32_t new_seed(void) {
+	return game.seed * 2654435761u + TMR3;
+}
+
+/**
+ * @brief Reads the buttons, or in a soak test (SW2 on) presses them instead of the player.
+ *
+ * In a soak test the autopilot plays every run until it reaches soak_score and then lets go
+ * of the buttons, so every run ends and goes through entering the score. On the other
+ * screens the button that moves on is pressed once the screen has been shown for
+ * SOAK_PAUSE_TICKS ticks: BTN4 in the menu and on the game over screen, BTN3 to save the
+ * name. Left on for hours, this plays, draws and stores runs over and over.
+ *
+ * @return The buttons, as returned by getbtns().
+ */
+int read_buttons(void) {
+	if(!(getsw() & 0x2)) { // SW2
+		return getbtns();
+	}
+
+	switch(currentState) {
+	case GAME_STATE:
+		return game.score < soak_score ? autopilot_buttons(&pilot, &game) : 0;
+
+	case MENU_STATE:
+	case GAME_OVER_STATE:
+		return idle_ticks >= SOAK_PAUSE_TICKS ? 0x4 : 0; // BTN4
+
+	case ENTER_NAME_STATE:
+		return idle_ticks >= SOAK_PAUSE_TICKS ? 0x2 : 0; // BTN3
+
+	default:
+		return getbtns();
+	}
+}
 
 /**
  * @brief Checks for input and performs corresponding actions based on the current state.
@@ -35,12 +112,19 @@ int delay_counter;
  */
 void check_for_input() {
 	if (delay_counter >= 4) {
+		int buttons = read_buttons();
+
 		switch (currentState) {
 		case MENU_STATE:
-			if(getbtns() & 0x4) { // BTN4
+			if(buttons & 0x4) { // BTN4
 				change_state(GAME_STATE);
 			}
-			else if(getbtns() & 0x1) { // BTN2
+			else if(buttons & 0x2) { // BTN3
+				if(has_best_replay) {
+					change_state(REPLAY_STATE);
+				}
+			}
+			else if(buttons & 0x1) { // BTN2
 				menu_page++;
 			}
 
@@ -48,10 +132,13 @@ void check_for_input() {
 			break;
 
 		case GAME_OVER_STATE:
-			if(getbtns() & 0x4) { // BTN4
+			if(buttons & 0x4) { // BTN4
 				change_state(GAME_STATE);
 			}
-			else if(getbtns() & 0x1) { // BTN2
+			else if(buttons & 0x2) { // BTN3
+				change_state(REWIND_STATE);
+			}
+			else if(buttons & 0x1) { // BTN2
 				change_state(MENU_STATE);
 			}
 
@@ -59,18 +146,18 @@ void check_for_input() {
 			break;
 
 		case ENTER_NAME_STATE:
-			if(getbtns() & 0x4) {
+			if(buttons & 0x4) {
 				initials[letter_index]++;
 				if(initials[letter_index] > 'z') {
 					initials[letter_index] = 'a';
 				}
 			}
-			else if(getbtns() & 0x2) {
+			else if(buttons & 0x2) {
 				letter_index = 0;
 				insert_initials(initials, leaderboard_index);
 				change_state(GAME_OVER_STATE);
 			}
-			else if(getbtns() & 0x1) {
+			else if(buttons & 0x1) {
 				letter_index = (letter_index + 1) % 3;
 			}
 
@@ -83,13 +170,44 @@ void check_for_input() {
 	}
 }
 
+/**
+ * @brief Leaves the rewind view.
+ *
+ * A paused run is played on from the tick shown, dropping the ticks after it from the replay
+ * and the rewind buffer. A run rewound to an earlier tick no longer races the ghost, which
+ * is still where it was. After a death the game is put back as it ended.
+ */
+void leave_rewind(void) {
+	if(rewind_resumable) {
+		if(rewind_tick != rewind_buffer.end) {
+			rewind_truncate(&rewind_buffer, rewind_tick);
+			replay_cut(&replay, rewind_tick);
+			ghost_running = 0;
+		}
+		currentState = GAME_STATE;
+		delay_counter = 0;
+		reset_display(&game);
+	} else {
+		rewind_load(&rewind_buffer, rewind_buffer.end, &game);
+		change_state(GAME_OVER_STATE);
+	}
+}
+
 /**
  * @brief Interrupt service routine for handling interrupts.
  * 
  * This function is called when an interrupt is triggered. For Timer 2 interrupts it 
  * increments the delay_counter, and based on the current state, it performs different actions:
- * - MENU_STATE: Checks for user input and draws the menu.
- * - GAME_STATE: Updates the game logic and updates the display.
+ * - MENU_STATE: Checks for user input and draws the menu. After ATTRACT_IDLE_TICKS ticks
+ *   without a button pressed the autopilot starts playing.
+ * - GAME_STATE: Updates the game logic with the buttons and records them in the replay and
+ *   the rewind buffer, steps the ghost in the same tick if the run races it, updates the LEDs
+ *   and the display, and when the game is over sends the replay over the UART and enters the
+ *   score. BTN2 and BTN3 held together pause the run in the rewind view.
+ * - REPLAY_STATE: Plays the top score's run with the buttons from its replay.
+ * - ATTRACT_STATE: Lets the autopilot play and draws the game, until a button is pressed.
+ * - REWIND_STATE: Steps the game one tick back while BTN3 is held, or forward while BTN4 is
+ *   held, through the ticks in the rewind buffer. BTN2 leaves.
  * - GAME_OVER_STATE: Checks for user input and draws the game over screen.
  * - ENTER_NAME_STATE: Checks for user input and draws the enter name screen. Reads the leaderboard.
  */
@@ -97,18 +215,91 @@ void user_isr(void) {
 	if(IFS(0) & 0x100) { // Timer 2 interrupt
 		IFSCLR(0) = 0x100;
 		delay_counter++;
+		idle_ticks++;
 
 		switch(currentState) {
 		case MENU_STATE:
+			if(getbtns()) {
+				idle_ticks = 0;
+			}
+			else if(idle_ticks >= ATTRACT_IDLE_TICKS) {
+				change_state(ATTRACT_STATE);
+				break;
+			}
 			check_for_input();
 			draw_menu();
 			break;
 
-		case GAME_STATE:
-			update_game();
-			update_display();
+		case GAME_STATE: {
+			int buttons = read_buttons();
+			if((buttons & 0x3) == 0x3) { // BTN2 and BTN3
+				change_state(REWIND_STATE);
+				break;
+			}
+			replay_record(&replay, buttons);
+			update_game(&game, buttons);
+			rewind_record(&rewind_buffer, &game, buttons);
+			if(ghost_running) {
+				update_game(&ghost, replay_next(&ghost_cursor));
+			}
+			update_LEDs(game.score_bcd);
+			update_display(&game, ghost_running ? &ghost : 0);
+			if(game.game_over) {
+				replay_finish(&replay, game.score);
+				uart_send_replay(&replay);
+#ifdef REWIND_DUMP
+				uart_send_rewind(&rewind_buffer);
+#endif
+				insert_score(game.score);
+			}
+			break;
+		}
+
+		case REPLAY_STATE: {
+			int buttons = replay_next(&replay_cursor);
+			update_game(&game, buttons);
+			rewind_record(&rewind_buffer, &game, buttons);
+			update_LEDs(game.score_bcd);
+			update_display(&game, 0);
+			if(game.game_over) {
+				change_state(GAME_OVER_STATE);
+			}
+			break;
+		}
+
+		case ATTRACT_STATE:
+			if(getbtns()) {
+				change_state(MENU_STATE);
+				break;
+			}
+			update_game(&game, autopilot_buttons(&pilot, &game));
+			update_LEDs(game.score_bcd);
+			update_display(&game, 0);
+			if(game.game_over) {
+				change_state(MENU_STATE);
+			}
 			break;
 
+		case REWIND_STATE: {
+			int buttons = getbtns();
+			int pressed = buttons & ~rewind_held;
+			rewind_held = buttons;
+
+			if(pressed & 0x1) { // BTN2
+				leave_rewind();
+				break;
+			}
+			if((buttons & 0x2) && rewind_tick > rewind_buffer.first) { // BTN3
+				rewind_load(&rewind_buffer, --rewind_tick, &game);
+			}
+			else if((buttons & 0x4) && rewind_tick < rewind_buffer.end) { // BTN4
+				rewind_step(&rewind_buffer, &game, ++rewind_tick);
+			}
+			update_LEDs(game.score_bcd);
+			update_display(&game, 0);
+			break;
+		}
+
 		case GAME_OVER_STATE:
 			check_for_input();
 			draw_gameover();
@@ -130,15 +321,59 @@ void user_isr(void) {
  * Changes the state of the game to the specified new state.
  * Resets the game and initializes the delay counter.
  *
+ * With SW1 on, a new run races the ghost of the top score: it gets the seed of the top
+ * score's run, so both meet the same obstacles, and that run is played alongside it.
+ * Every run and replay is recorded in the rewind buffer, which the rewind view starts at
+ * the end of. The debug build sends the buffer over the UART when the view is opened.
+ *
  * @param newState The new state to change to.
  */
 void change_state(GameState newState) {
 	currentState = newState;
 	delay_counter = 0;
+	idle_ticks = 0;
 
 	switch(currentState) {
 		case GAME_STATE:
-			reset_game();
+			ghost_running = has_best_replay && (getsw() & 0x1); // SW1
+			if(ghost_running) {
+				reset_game(&game, &game_rules, best_replay.seed);
+				reset_game(&ghost, &game_rules, best_replay.seed);
+				replay_rewind(&ghost_cursor, &best_replay);
+			} else {
+				reset_game(&game, &game_rules, new_seed());
+			}
+			replay_start(&replay, game.seed);
+			rewind_start(&rewind_buffer, &game);
+			autopilot_reset(&pilot, &game, 0);
+			soak_score = SOAK_MIN_SCORE + game.seed % SOAK_SCORE_RANGE;
+			update_LEDs(game.score_bcd);
+			reset_display(&game);
+			break;
+
+		case ATTRACT_STATE:
+			reset_game(&game, &game_rules, new_seed());
+			autopilot_reset(&pilot, &game, 0);
+			update_LEDs(game.score_bcd);
+			reset_display(&game);
+			break;
+
+		case REPLAY_STATE:
+			reset_game(&game, &game_rules, best_replay.seed);
+			replay_rewind(&replay_cursor, &best_replay);
+			rewind_start(&rewind_buffer, &game);
+			update_LEDs(game.score_bcd);
+			reset_display(&game);
+			break;
+
+		case REWIND_STATE:
+			rewind_tick = rewind_buffer.end;
+			rewind_held = getbtns();
+			rewind_resumable = !game.game_over;
+#ifdef REWIND_DUMP
+			uart_send_rewind(&rewind_buffer);
+#endif
+			reset_display(&game);
 			break;
 
 		default:
@@ -149,17 +384,25 @@ void change_state(GameState newState) {
 /**
  * @brief The main function of the program.
  * 
- * This function initializes the chip, sets the initial state to MENU_STATE,
- * reads the leaderboard scores, and sets the highscore to the first score in the leaderboard.
+ * This function initializes the chip, sets the initial state to MENU_STATE, builds the
+ * game rules, reads the leaderboard scores and the replay of the top score, and sets the
+ * highscore to the first score in the leaderboard. Only then are interrupts enabled, so
+ * the timer interrupt never sees the rules or the leaderboard half set up.
  * It then enters an infinite loop to keep the program running.
  * 
  * @return 0 indicating successful program execution. (This is never reached.)
  */
 int main(void) {
 	chip_init(); // Set up timers, interrupts, input and outputs, display, I2C etc.
+#ifdef BENCH
+	bench_run(&board_clock); // Before interrupts are enabled, the timer interrupt would draw into the frame being timed
+#endif
 	currentState = MENU_STATE;
+	build_game_rules(&game_rules);
 	read_leaderboard();
 	highscore = leaderboard_scores[0];
+	has_best_replay = read_replay(&best_replay);
+	enable_interrupt(); // Enable global interrupts
 
 	while (1) {} // Infinite loop to keep the program running
 	return 0;
@@ -2,7 +2,8 @@
  * @file menu.c
  * @brief This file contains the implementation of the menu state.
  *
- * The menu state is responsible for displaying the menu screen
+ * The menu state is responsible for displaying the menu screen,
+ * starting with the full-screen title art
  * 
  * @author Elias Hollstrand
  * @author Mattias Kvist
@@ -15,42 +16,51 @@
 #include <pic32mx.h> /* Declarations of system-specific addresses etc */
 #include "declare.h" /* Declarations for these labs */
 
-int highscore;
 int menu_page = 0;
 
 /**
  * Function to draw the menu on the display.
- * This function clears all pixels, fills the top and bottom borders,
- * and displays different menu pages based on the value of menu_page.
- * Each menu page displays different strings on the display.
+ * This function clears all pixels and displays different menu pages based on the value of menu_page.
+ * The first page shows the title art, the other pages fill the top and bottom borders
+ * and display different strings on the display.
  */
 void draw_menu() {
     // Clear all pixels on the display
     clear_all_pixels();
 
+    // The title page is full-screen art, the other pages have borders
+    if(menu_page % 5 == 0) {
+        draw_image(0, 0, &title);
+        display_objects();
+        return;
+    }
+
     // Fill the top and bottom borders
     fill_rectangle(0, 0, 127, 1);
     fill_rectangle(0, 31, 127, 1);
 
     // Display different menu pages based on the value of menu_page
-    switch(menu_page % 4) {
-    case 0:
+    switch(menu_page % 5) {
+    case 1:
         // Display menu controls
         draw_string(25, 3, "menu controls");
         draw_string(0, 10, "start: btn4");
         draw_string(0, 17, "next: btn2");
+        draw_string(0, 24, "replay: btn3");
         break;
-    case 1:
+    case 2:
         // Display controls
         draw_string(40, 3, "controls");
         draw_string(0, 10, "jump: btn4");
         draw_string(0, 17, "duck: btn3");
+        draw_string(0, 24, "ghost: sw1 on");
+        draw_string(66, 10, "rewind:2+3");
         break;
-    case 2:
+    case 3:
         // Display leaderboard
         draw_leaderboard();
         break;
-    case 3:
+    case 4:
         // Display credits
         draw_string(40, 3, "credits");
         draw_string(0, 10, "mattias kvist");
@@ -0,0 +1,113 @@
+/**
+ * @file oled.c
+ * @brief Driver for the OLED display on the Basic I/O Shield.
+ *
+ * This file contains the functions that talk to the display module over SPI: initializing
+ * the display and sending it the changed parts of the `pixel_data` frame buffer.
+ * The drawing functions in display.c only work on the frame buffer, so this is the only
+ * part of the graphics that depends on the hardware.
+ *
+ * @author Axel Isaksson
+ * @author F Lundevall
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * @date 2023-12-10
+ *
+ * For copyright and licensing, see file COPYING
+ */
+
+#include <stdint.h>   /* Declarations of uint_32 and the like */
+#include <pic32mx.h>  /* Declarations of system-specific addresses etc */
+#include "declare.h"  /* Declatations for these labs */
+
+#define DISPLAY_CHANGE_TO_COMMAND_MODE (PORTFCLR = 0x10)
+#define DISPLAY_CHANGE_TO_DATA_MODE (PORTFSET = 0x10)
+#define DISPLAY_ACTIVATE_RESET (PORTGCLR = 0x200)
+#define DISPLAY_DO_NOT_RESET (PORTGSET = 0x200)
+#define DISPLAY_ACTIVATE_VDD (PORTFCLR = 0x40)
+#define DISPLAY_ACTIVATE_VBAT (PORTFCLR = 0x20)
+#define DISPLAY_TURN_OFF_VDD (PORTFSET = 0x40)
+#define DISPLAY_TURN_OFF_VBAT (PORTFSET = 0x20)
+
+/* quicksleep:
+   A simple function to create a small delay.
+   Very inefficient use of computing resources,
+   but very handy in some special cases. */
+void quicksleep(int cyc) {
+	int i;
+	for(i = cyc; i > 0; i--);
+}
+
+uint8_t spi_send_recv(uint8_t data) {
+	while(!(SPI2STAT & 0x08));
+	SPI2BUF = data;
+	while(!(SPI2STAT & 1));
+	return SPI2BUF;
+}
+
+void display_init(void) {
+    DISPLAY_CHANGE_TO_COMMAND_MODE;
+	quicksleep(10);
+	DISPLAY_ACTIVATE_VDD;
+	quicksleep(1000000);
+	
+	spi_send_recv(0xAE);
+	DISPLAY_ACTIVATE_RESET;
+	quicksleep(10);
+	DISPLAY_DO_NOT_RESET;
+	quicksleep(10);
+	
+	spi_send_recv(0x8D);
+	spi_send_recv(0x14);
+	
+	spi_send_recv(0xD9);
+	spi_send_recv(0xF1);
+	
+	DISPLAY_ACTIVATE_VBAT;
+	quicksleep(10000000);
+	
+	spi_send_recv(0xA1);
+	spi_send_recv(0xC8);
+	
+	spi_send_recv(0xDA);
+	spi_send_recv(0x20);
+	
+	spi_send_recv(0xAF);
+}
+
+/**
+ * @brief Updates the display with the pixel data stored in the pixel_data array.
+ * 
+ * This function sends the pixel data stored in the pixel_data array to the display.
+ * It uses SPI communication to send the data to the display module.
+ * The display is divided into 4 pages, and only the columns of each page that were
+ * marked dirty since the last update are sent. Pages without changes are skipped.
+ * 
+ * @note This function is based on display_update from labs.
+ */
+// Based on display_update from labs
+void display_objects(void) {
+	int i, j;
+	for(i = 0; i < 4; i++) {
+		int start = dirty_start[i];
+		int end = dirty_end[i];
+		if(start >= end) {
+			continue;
+		}
+
+		DISPLAY_CHANGE_TO_COMMAND_MODE;
+		spi_send_recv(0xB0 | i);          // page address
+		spi_send_recv(0x00 | (start & 0xF)); // lower nibble of the start column
+		spi_send_recv(0x10 | (start >> 4));  // upper nibble of the start column
+		
+		DISPLAY_CHANGE_TO_DATA_MODE;
+		
+		for(j = start; j < end; j++) {
+			spi_send_recv(pixel_data[i][j]);
+		}
+
+		dirty_start[i] = 128;
+		dirty_end[i] = 0;
+	}
+}
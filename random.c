@@ -0,0 +1,168 @@
+/**
+ * @file random.c
+ * @brief This file contains the seedable random number generator used by the game.
+ *
+ * The generator is PCG32: a 64-bit linear congruential state with a permuted 32-bit
+ * output. The increment of the LCG selects one of 2^63 independent streams. The game
+ * draws its spawns from one stream derived from the seed, and anything else that needs
+ * random numbers from the same seed (like the bot of tools/dino-balance) takes another
+ * stream, so drawing from it never changes which obstacles are spawned.
+ *
+ * Weighted choices use alias tables (Vose's method): the weights are turned into one
+ * coin per entry and an alias to take when the coin fails, so drawing from any number
+ * of weighted entries costs one random number, a multiplication and a compare.
+ *
+ * Every game keeps its own stream, seeded by reset_game(). Everything in a run follows
+ * from its seed, which is shown on the game over screen, so any run can be reproduced
+ * by starting a game with the same seed.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include "declare.h" /* Declatations for these labs */
+
+#define PCG_MULTIPLIER 6364136223846793005ULL
+
+/**
+ * @brief Seeds a generator and selects its stream.
+ *
+ * Generators with the same seed but different streams produce unrelated sequences.
+ *
+ * @param rng The generator to seed.
+ * @param seed The starting point within the stream.
+ * @param stream The stream to use.
+ */
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream) {
+	rng->state = 0;
+	rng->increment = (stream << 1) | 1; // The increment has to be odd
+	rng_next(rng);
+	rng->state += seed;
+	rng_next(rng);
+}
+
+/**
+ * @brief Returns the next 32 random bits of a generator.
+ *
+ * The old state is permuted with an xorshift and a rotation by its top bits,
+ * which hides the weak low bits of the LCG.
+ *
+ * @param rng The generator to step.
+ * @return A uniformly distributed 32-bit number.
+ */
+uint32_t rng_next(Rng *rng) {
+	uint64_t old = rng->state;
+	rng->state = old * PCG_MULTIPLIER + rng->increment;
+
+	uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+	uint32_t rotation = old >> 59;
+	return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+}
+
+/**
+ * @brief Returns a uniformly distributed number in [0, bound).
+ *
+ * The random bits are scaled with a multiplication instead of taking them modulo
+ * bound, and the few values that would make some results more likely are rejected.
+ * The division that finds those values is only needed in the rare case that the
+ * low half of the product falls below bound.
+ *
+ * @param rng The generator to use.
+ * @param bound The number of possible results, at least 1.
+ * @return A number in [0, bound).
+ */
+uint32_t rng_below(Rng *rng, uint32_t bound) {
+	uint64_t product = (uint64_t)rng_next(rng) * bound;
+	uint32_t low = (uint32_t)product;
+
+	if(low < bound) {
+		uint32_t threshold = -bound % bound;
+		while(low < threshold) {
+			product = (uint64_t)rng_next(rng) * bound;
+			low = (uint32_t)product;
+		}
+	}
+
+	return product >> 32;
+}
+
+/**
+ * @brief Builds an alias table for drawing entries with the given weights.
+ *
+ * Every entry is scaled so that the average weight fills one slot. Entries below
+ * the average are topped up with the surplus of an entry above it, which becomes
+ * their alias; the entry that gave the surplus then goes back into the lists.
+ * Entries left over at the end fill their slot exactly and never use their alias.
+ *
+ * If every weight is zero there is nothing to draw, and the table is left with no
+ * entries instead of drawing every entry equally often. It must not be drawn from.
+ *
+ * @param table The table to build.
+ * @param weights The relative weight of each entry.
+ * @param count The number of entries, at most MAX_ALIAS_ENTRIES.
+ * @return 1 if the table was built, 0 if every weight is zero.
+ */
+int build_alias_table(AliasTable *table, const uint8_t *weights, int count) {
+	uint32_t scaled[MAX_ALIAS_ENTRIES];
+	uint8_t small[MAX_ALIAS_ENTRIES];
+	uint8_t large[MAX_ALIAS_ENTRIES];
+	int small_count = 0, large_count = 0;
+	uint32_t total = 0;
+	int i;
+
+	for(i = 0; i < count; i++) {
+		total += weights[i];
+	}
+	if(total == 0) {
+		table->count = 0;
+		return 0;
+	}
+
+	table->count = count;
+	for(i = 0; i < count; i++) {
+		scaled[i] = weights[i] * count; // A full slot is now worth total
+		table->alias[i] = i;
+		table->threshold[i] = 65536;
+		if(scaled[i] < total) {
+			small[small_count++] = i;
+		} else {
+			large[large_count++] = i;
+		}
+	}
+
+	while(small_count > 0 && large_count > 0) {
+		int under = small[--small_count];
+		int over = large[--large_count];
+
+		table->threshold[under] = (scaled[under] << 16) / total;
+		table->alias[under] = over;
+
+		scaled[over] -= total - scaled[under];
+		if(scaled[over] < total) {
+			small[small_count++] = over;
+		} else {
+			large[large_count++] = over;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Draws an entry from an alias table.
+ *
+ * The top 16 bits of one random number pick a slot and the low 16 bits toss
+ * its coin, so the cost does not depend on the number of entries.
+ *
+ * @param table The table to draw from.
+ * @param rng The generator to use.
+ * @return The index of the drawn entry.
+ */
+int alias_sample(const AliasTable *table, Rng *rng) {
+	uint32_t bits = rng_next(rng);
+	int slot = ((bits >> 16) * table->count) >> 16;
+
+	return (bits & 0xFFFF) < table->threshold[slot] ? slot : table->alias[slot];
+}
@@ -0,0 +1,202 @@
+/**
+ * @file replay.c
+ * @brief Recording and playing back runs as a seed and the buttons of every tick.
+ *
+ * Everything in a run follows from its seed and the buttons held down on each tick,
+ * so that is all a replay keeps. The buttons are stored as runs of ticks with the same
+ * buttons, one byte per run: the buttons (as returned by getbtns()) in the top 3 bits
+ * and the number of ticks minus one in the low 5. A run that holds the same buttons for
+ * longer takes one byte per 32 ticks, so a run of a few minutes fits in a few hundred
+ * bytes.
+ *
+ * When a replay is stored in the EEPROM or sent over the UART it is written as a header
+ * of REPLAY_HEADER_BYTES bytes, with every field little-endian, followed by the runs:
+ *
+ *     magic (1)  flags (1)  length of the runs (2)  seed (4)  score (4)
+ *
+ * The same file builds for the ChipKIT and for the host tools, so a replay recorded on
+ * the board plays back exactly the same game in tools/dino-sim.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include "declare.h" /* Declatations for these labs */
+
+#define RUN_TICKS 32 // Most ticks in one run byte
+#define RUN_BUTTONS(run) ((run) >> 5)
+#define RUN_LENGTH(run) (((run) & (RUN_TICKS - 1)) + 1)
+
+/**
+ * @brief Starts recording a run.
+ *
+ * @param replay The replay to record into.
+ * @param seed The seed the run was started with.
+ */
+void replay_start(Replay *replay, uint32_t seed) {
+	replay->seed = seed;
+	replay->score = 0;
+	replay->length = 0;
+	replay->flags = 0;
+}
+
+/**
+ * @brief Records the buttons of one tick.
+ *
+ * The tick is added to the last run if it has the same buttons and room for one more
+ * tick. When the replay is full the rest of the run is not recorded and the replay is
+ * marked as truncated.
+ *
+ * @param replay The replay being recorded.
+ * @param buttons The buttons passed to update_game() this tick.
+ */
+void replay_record(Replay *replay, int buttons) {
+	buttons &= 0x7;
+	if(replay->flags & REPLAY_TRUNCATED) {
+		return;
+	}
+	if(replay->length > 0) {
+		uint8_t *last = &replay->runs[replay->length - 1];
+
+		if(RUN_BUTTONS(*last) == buttons && RUN_LENGTH(*last) < RUN_TICKS) {
+			(*last)++;
+			return;
+		}
+	}
+	if(replay->length < REPLAY_BYTES) {
+		replay->runs[replay->length++] = buttons << 5;
+	} else {
+		replay->flags |= REPLAY_TRUNCATED;
+	}
+}
+
+/**
+ * @brief Ends the recording of a run.
+ *
+ * @param replay The replay being recorded.
+ * @param score The score the run ended with.
+ */
+void replay_finish(Replay *replay, int score) {
+	replay->score = score;
+}
+
+/**
+ * @brief Forgets the ticks recorded after a tick, so that recording goes on from there.
+ *
+ * Used when a run is rewound and played on from an earlier tick. If the replay was
+ * truncated before that tick it stays truncated.
+ *
+ * @param replay The replay being recorded.
+ * @param ticks The number of ticks to keep.
+ */
+void replay_cut(Replay *replay, uint32_t ticks) {
+	int i;
+
+	for(i = 0; i < replay->length; i++) {
+		int length = RUN_LENGTH(replay->runs[i]);
+
+		if(ticks <= length) {
+			if(ticks == 0) {
+				replay->length = i;
+			} else {
+				replay->runs[i] = (replay->runs[i] & ~(RUN_TICKS - 1)) | (ticks - 1);
+				replay->length = i + 1;
+			}
+			replay->flags &= ~REPLAY_TRUNCATED;
+			return;
+		}
+		ticks -= length;
+	}
+}
+
+/**
+ * @brief Counts the ticks recorded in a replay.
+ */
+uint32_t replay_ticks(const Replay *replay) {
+	uint32_t ticks = 0;
+	int i;
+
+	for(i = 0; i < replay->length; i++) {
+		ticks += RUN_LENGTH(replay->runs[i]);
+	}
+	return ticks;
+}
+
+/**
+ * @brief Starts playing back a replay from its first tick.
+ *
+ * The game has to be started with reset_game() and the seed of the replay.
+ */
+void replay_rewind(ReplayCursor *cursor, const Replay *replay) {
+	cursor->replay = replay;
+	cursor->run = 0;
+	cursor->ticks = 0;
+}
+
+/**
+ * @brief Returns the buttons of the next tick of a replay and moves on.
+ *
+ * @return The buttons to pass to update_game(), or 0 once the replay has ended.
+ */
+int replay_next(ReplayCursor *cursor) {
+	const Replay *replay = cursor->replay;
+	uint8_t run;
+
+	if(cursor->run >= replay->length) {
+		return 0;
+	}
+	run = replay->runs[cursor->run];
+	if(++cursor->ticks == RUN_LENGTH(run)) {
+		cursor->run++;
+		cursor->ticks = 0;
+	}
+	return RUN_BUTTONS(run);
+}
+
+/**
+ * @brief Writes the header of a replay, for storing or sending it before the runs.
+ *
+ * @param replay The replay.
+ * @param header The REPLAY_HEADER_BYTES bytes to write the header to.
+ */
+void replay_encode_header(const Replay *replay, uint8_t *header) {
+	int i;
+
+	header[0] = REPLAY_MAGIC;
+	header[1] = replay->flags;
+	header[2] = replay->length & 0xFF;
+	header[3] = replay->length >> 8;
+	for(i = 0; i < 4; i++) {
+		header[4 + i] = replay->seed >> (8 * i);
+		header[8 + i] = replay->score >> (8 * i);
+	}
+}
+
+/**
+ * @brief Reads the header of a stored or received replay.
+ *
+ * The runs, length bytes of them, follow the header and are read by the caller.
+ *
+ * @param replay The replay to fill in.
+ * @param header The REPLAY_HEADER_BYTES bytes of the header.
+ * @return 1 if the header is valid, 0 if there is no replay (for example an erased EEPROM).
+ */
+int replay_decode_header(Replay *replay, const uint8_t *header) {
+	int i;
+
+	if(header[0] != REPLAY_MAGIC || (header[2] | header[3] << 8) > REPLAY_BYTES) {
+		return 0;
+	}
+	replay->flags = header[1];
+	replay->length = header[2] | header[3] << 8;
+	replay->seed = 0;
+	replay->score = 0;
+	for(i = 0; i < 4; i++) {
+		replay->seed |= (uint32_t)header[4 + i] << (8 * i);
+		replay->score |= (uint32_t)header[8 + i] << (8 * i);
+	}
+	return 1;
+}
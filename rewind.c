@@ -0,0 +1,187 @@
+/**
+ * @file rewind.c
+ * @brief A ring buffer of the last seconds of a run, for stepping a game backward.
+ *
+ * A game follows from its state and the buttons of every tick, so the buffer does not
+ * keep a full state for every tick. Every REWIND_KEYFRAME_TICKS ticks it copies the whole
+ * GameContext into a keyframe, and for every tick in between it keeps one byte: the
+ * buttons in the top 3 bits, like a replay, and a 5-bit check of the state after the tick
+ * in the low 5. Any tick still in the buffer is rebuilt by copying the keyframe before it
+ * and playing the buttons forward with update_game(), at most REWIND_KEYFRAME_TICKS - 1
+ * ticks of work. Recording a tick costs one hash and one byte; every
+ * REWIND_KEYFRAME_TICKS ticks the struct copy is added to that.
+ *
+ * The check bits catch a state that does not follow from the one before it, as a corrupted
+ * GameContext or a glitch in the game logic would leave behind: rebuilding that tick gives
+ * a different state, whose check does not match the one recorded when it was played.
+ *
+ * With REWIND_KEYFRAMES keyframes the buffer always holds at least
+ * (REWIND_KEYFRAMES - 1) * REWIND_KEYFRAME_TICKS ticks, about 7.5 seconds, in about 1.5 KB.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include "declare.h" /* Declatations for these labs */
+
+#define CHECK_BITS 0x1F
+#define TICK_BUTTONS(tick) ((tick) >> 5)
+#define TICK_CHECK(tick) ((tick) & CHECK_BITS)
+
+/**
+ * @brief Hashes the fields of a game that change from tick to tick down to 5 bits.
+ */
+int rewind_check(const GameContext *game) {
+	uint32_t hash = game->character_y_q8;
+
+	hash = (hash ^ game->y_velocity) * 0x9E3779B1u;
+	hash = (hash ^ game->obstacle_x_q8) * 0x9E3779B1u;
+	hash = (hash ^ game->score) * 0x9E3779B1u;
+	hash = (hash ^ game->dino_frames_passed ^ game->obstacle_ticks << 8 ^ game->action << 16 ^ game->game_over << 24) * 0x9E3779B1u;
+	hash = (hash ^ (uint32_t)game->spawn_rng.state) * 0x9E3779B1u;
+	return hash >> 27;
+}
+
+/**
+ * @brief Starts recording a run into the buffer, forgetting whatever it held.
+ *
+ * @param rewind The buffer.
+ * @param game The game, just reset.
+ */
+void rewind_start(RewindBuffer *rewind, const GameContext *game) {
+	rewind->keyframes[0] = *game;
+	rewind->first = 0;
+	rewind->end = 0;
+}
+
+/**
+ * @brief Records a tick that has just been played.
+ *
+ * Starting a new keyframe drops the oldest one and the ticks after it.
+ *
+ * @param rewind The buffer.
+ * @param game The game, after update_game().
+ * @param buttons The buttons passed to update_game().
+ */
+void rewind_record(RewindBuffer *rewind, const GameContext *game, int buttons) {
+	rewind->ticks[rewind->end % REWIND_TICKS] = (buttons & 0x7) << 5 | rewind_check(game);
+	rewind->end++;
+
+	if(rewind->end % REWIND_KEYFRAME_TICKS == 0) {
+		rewind->keyframes[rewind->end / REWIND_KEYFRAME_TICKS % REWIND_KEYFRAMES] = *game;
+		if(rewind->end - rewind->first >= REWIND_TICKS) {
+			rewind->first += REWIND_KEYFRAME_TICKS;
+		}
+	}
+}
+
+/**
+ * @brief Moves a game one tick forward within the buffer.
+ *
+ * On a keyframe the game is copied from it, so the state is the one that was played
+ * even if the ticks before it were not rebuilt correctly.
+ *
+ * @param rewind The buffer.
+ * @param game The game after tick - 1 ticks of the run. It is left after tick ticks.
+ * @param tick The tick to move to, after the first and at most the end of the buffer.
+ * @return 1 if the state matches the check recorded for it, 0 if it does not.
+ */
+int rewind_step(const RewindBuffer *rewind, GameContext *game, uint32_t tick) {
+	uint8_t recorded = rewind->ticks[(tick - 1) % REWIND_TICKS];
+
+	if(tick % REWIND_KEYFRAME_TICKS == 0) {
+		*game = rewind->keyframes[tick / REWIND_KEYFRAME_TICKS % REWIND_KEYFRAMES];
+	} else {
+		update_game(game, TICK_BUTTONS(recorded));
+	}
+	return rewind_check(game) == TICK_CHECK(recorded);
+}
+
+/**
+ * @brief Rebuilds the state of a game at a tick still in the buffer.
+ *
+ * @param rewind The buffer.
+ * @param tick The number of ticks into the run, from rewind->first to rewind->end.
+ * @param game The game to overwrite with the state after that many ticks.
+ * @return 1 if every tick rebuilt matched its check, 0 otherwise.
+ */
+int rewind_load(const RewindBuffer *rewind, uint32_t tick, GameContext *game) {
+	uint32_t keyframe = tick - tick % REWIND_KEYFRAME_TICKS;
+	int matched = 1;
+
+	*game = rewind->keyframes[keyframe / REWIND_KEYFRAME_TICKS % REWIND_KEYFRAMES];
+	while(keyframe < tick) {
+		matched &= rewind_step(rewind, game, ++keyframe);
+	}
+	return matched;
+}
+
+/**
+ * @brief Forgets the ticks after a tick, so that recording goes on from there.
+ *
+ * @param rewind The buffer.
+ * @param tick The tick to keep as the last one, from rewind->first to rewind->end.
+ */
+void rewind_truncate(RewindBuffer *rewind, uint32_t tick) {
+	rewind->end = tick;
+}
+
+/**
+ * @brief Writes a 32-bit number as 8 hex digits.
+ */
+static char *put_hex(char *line, uint32_t value) {
+	const char *digits = "0123456789abcdef";
+	int shift;
+
+	for(shift = 28; shift >= 0; shift -= 4) {
+		*line++ = digits[(value >> shift) & 0xF];
+	}
+	return line;
+}
+
+/**
+ * @brief Writes one line of the debug dump of the buffer.
+ *
+ * The line is the word "rewind", the tick and the fields that change from tick to tick, as
+ * hex words, and "ok" or "BAD" for whether the state matched its check:
+ *
+ *     rewind <tick> <buttons> <character_y_q8> <y_velocity> <obstacle_x_q8> <score> <game_over> ok
+ *
+ * @param line At least REWIND_LINE_BYTES bytes to write the line to, ended by a 0.
+ * @param tick The tick of the state.
+ * @param buttons The buttons that led to it.
+ * @param game The state after tick ticks.
+ * @param matched Whether the state matched its check.
+ */
+void rewind_format(char *line, uint32_t tick, int buttons, const GameContext *game, int matched) {
+	const char *word = "rewind ";
+	const char *result = matched ? " ok\r\n" : " BAD\r\n";
+	uint32_t fields[] = {
+		tick, buttons, game->character_y_q8, game->y_velocity, game->obstacle_x_q8, game->score, game->game_over,
+	};
+	int i;
+
+	while(*word) {
+		*line++ = *word++;
+	}
+	for(i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+		if(i > 0) {
+			*line++ = ' ';
+		}
+		line = put_hex(line, fields[i]);
+	}
+	while(*result) {
+		*line++ = *result++;
+	}
+	*line = 0;
+}
+
+/**
+ * @brief Returns the buttons recorded for a tick still in the buffer.
+ */
+int rewind_buttons(const RewindBuffer *rewind, uint32_t tick) {
+	return TICK_BUTTONS(rewind->ticks[(tick - 1) % REWIND_TICKS]);
+}
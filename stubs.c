@@ -4,8 +4,15 @@
 
  * For copyright and licensing, see file COPYING */
 
-/* Non-Maskable Interrupt; something bad likely happened, so hang */
+#include <stdint.h>
+#include "declare.h"
+
+/* Non-Maskable Interrupt; something bad likely happened, so hang.
+   The debug build first sends the last seconds of the run over the UART. */
 void _nmi_handler() {
+#ifdef REWIND_DUMP
+	uart_send_rewind(&rewind_buffer);
+#endif
 	for(;;);
 }
 
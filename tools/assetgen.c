@@ -0,0 +1,877 @@
+/**
+ * @file assetgen.c
+ * @brief Host tool that converts the images in assets/ into data.c and data.h.
+ *
+ * The tool reads a manifest (assets/assets.txt) where every line names one asset:
+ *
+ *     <kind> <name> <image file> [options]
+ *
+ * where kind is "sprite" or "font". Images can be plain or raw PBM files (P1/P4)
+ * or ASCII-art text files where '#', 'X', '*' and '1' are set pixels.
+ *
+ * Sprites are stored in the same layout as the display: the image is split into
+ * pages of 8 rows, and each page is stored as one byte per column with bit 0 being
+ * the top row of the page. For every sprite the tool emits a Sprite descriptor and
+ * NAME_WIDTH / NAME_HEIGHT constants, so game code never hard-codes asset sizes.
+ *
+ * Sprites with the option "compiled" also get a generated blit function: straight-line
+ * code with the column masks as constants that ORs the sprite into pixel_data, used by
+ * draw_image() whenever the sprite is completely on screen.
+ *
+ * Sprites with the option "preshift" instead get 8 copies of their packed columns,
+ * copy k being the sprite moved down by k rows, so that a sprite at any y can be drawn
+ * with plain byte ORs into whole pages. This costs flash, which the tool reports for
+ * every such sprite, in exchange for not shifting anything at run time.
+ *
+ * Sprites that are neither compiled nor pre-shifted are run-length encoded instead of
+ * packed when that is smaller, which is the case for large, mostly empty images such
+ * as full-screen art. Each page of the RLE stream is a list of (skip, count) records:
+ * skip empty columns, then count literal column bytes follow. The records of a page
+ * end exactly at the sprite width. Option "packed" keeps a sprite packed regardless.
+ *
+ * Sprites with the option "mask" also get a collision mask: one 32-bit word per column
+ * with bit y set where row y of the sprite is set, used by sprites_collide() to test
+ * two sprites for overlapping pixels with a shift and an AND per column.
+ *
+ * Animations list sprites declared earlier in the manifest as their frames:
+ *
+ *     animation <name> <frame> <frame> ...
+ *
+ * All frames must have the same size and must not be run-length encoded. For every
+ * step from one frame to the next the tool emits the spans of columns that change,
+ * so an animation that stays in place only redraws (and flushes) those columns.
+ *
+ * Fonts are sliced into equally sized cells (option cell=WxH, at most 8 rows high)
+ * read left to right, top to bottom, and emitted as a table of packed columns.
+ * Option count=N limits the number of glyphs taken from the sheet.
+ *
+ * Usage: assetgen <manifest> <output.c> <output.h>
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE 512
+#define MAX_PATH 512
+#define MAX_NAME 64
+#define BYTES_PER_LINE 12
+#define MAX_SPRITES 64
+#define MAX_FRAMES 16
+
+typedef struct {
+	int width;
+	int height;
+	uint8_t *pixels; // one byte per pixel, 1 = set
+} Image;
+
+typedef struct {
+	char name[MAX_NAME];
+	Image image;
+	int rle;
+} SpriteEntry;
+
+static const char *manifest_path;
+static int manifest_line;
+
+// Sprites emitted so far, so that animations can refer to them by name
+static SpriteEntry sprites[MAX_SPRITES];
+static int sprite_count;
+
+/**
+ * @brief Prints an error message with the current manifest position and exits.
+ */
+static void fail(const char *format, ...) {
+	va_list args;
+
+	fprintf(stderr, "%s:%d: ", manifest_path, manifest_line);
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+	exit(1);
+}
+
+/**
+ * @brief Reads the next whitespace separated token of a PBM header, skipping comments.
+ */
+static int pbm_read_int(FILE *file) {
+	int c, value = 0, digits = 0;
+
+	while((c = fgetc(file)) != EOF) {
+		if(c == '#') {
+			while((c = fgetc(file)) != EOF && c != '\n');
+		} else if(isdigit(c)) {
+			break;
+		} else if(!isspace(c)) {
+			return -1;
+		}
+	}
+
+	while(c != EOF && isdigit(c)) {
+		value = value * 10 + (c - '0');
+		digits++;
+		c = fgetc(file);
+	}
+
+	return digits ? value : -1;
+}
+
+/**
+ * @brief Loads a plain (P1) or raw (P4) PBM image.
+ */
+static void load_pbm(FILE *file, const char *path, Image *image) {
+	char magic[2];
+	int x, y, c;
+
+	if(fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '1' && magic[1] != '4')) {
+		fail("%s: not a PBM image", path);
+	}
+
+	image->width = pbm_read_int(file);
+	image->height = pbm_read_int(file);
+	if(image->width <= 0 || image->height <= 0) {
+		fail("%s: bad PBM size", path);
+	}
+
+	image->pixels = calloc(image->width * image->height, 1);
+
+	if(magic[1] == '1') {
+		for(y = 0; y < image->height; y++) {
+			for(x = 0; x < image->width; x++) {
+				do {
+					c = fgetc(file);
+					if(c == '#') {
+						while((c = fgetc(file)) != EOF && c != '\n');
+					}
+				} while(c != EOF && c != '0' && c != '1');
+
+				if(c == EOF) {
+					fail("%s: truncated PBM data", path);
+				}
+				image->pixels[y * image->width + x] = c == '1';
+			}
+		}
+	} else {
+		int stride = (image->width + 7) / 8;
+		uint8_t *row = malloc(stride);
+
+		for(y = 0; y < image->height; y++) {
+			if(fread(row, 1, stride, file) != (size_t)stride) {
+				fail("%s: truncated PBM data", path);
+			}
+			for(x = 0; x < image->width; x++) {
+				image->pixels[y * image->width + x] = (row[x / 8] >> (7 - x % 8)) & 1;
+			}
+		}
+		free(row);
+	}
+}
+
+/**
+ * @brief Loads an ASCII-art image. The width is the length of the longest line.
+ */
+static void load_ascii(FILE *file, const char *path, Image *image) {
+	char line[MAX_LINE];
+	char **lines = NULL;
+	int count = 0, width = 0, x, y;
+
+	while(fgets(line, sizeof(line), file)) {
+		int length = strcspn(line, "\r\n");
+		line[length] = 0;
+		if(length > width) {
+			width = length;
+		}
+		lines = realloc(lines, (count + 1) * sizeof(char *));
+		lines[count++] = strdup(line);
+	}
+
+	// Trailing empty lines are not part of the image
+	while(count > 0 && lines[count - 1][0] == 0) {
+		free(lines[--count]);
+	}
+
+	if(count == 0 || width == 0) {
+		fail("%s: empty image", path);
+	}
+
+	image->width = width;
+	image->height = count;
+	image->pixels = calloc(width * count, 1);
+
+	for(y = 0; y < count; y++) {
+		for(x = 0; lines[y][x]; x++) {
+			char c = lines[y][x];
+			image->pixels[y * width + x] = c == '#' || c == 'X' || c == '*' || c == '1';
+		}
+		free(lines[y]);
+	}
+	free(lines);
+}
+
+/**
+ * @brief Loads an image, choosing the format from its contents.
+ */
+static void load_image(const char *path, Image *image) {
+	FILE *file = fopen(path, "rb");
+	int c;
+
+	if(!file) {
+		fail("cannot open %s", path);
+	}
+
+	c = fgetc(file);
+	ungetc(c, file);
+	if(c == 'P') {
+		load_pbm(file, path, image);
+	} else {
+		load_ascii(file, path, image);
+	}
+
+	fclose(file);
+}
+
+/**
+ * @brief Returns the pixel at (x, y), or 0 outside the image.
+ */
+static int pixel(const Image *image, int x, int y) {
+	if(x < 0 || y < 0 || x >= image->width || y >= image->height) {
+		return 0;
+	}
+	return image->pixels[y * image->width + x];
+}
+
+/**
+ * @brief Packs a rectangle of an image into display pages.
+ *
+ * Rows are grouped in pages of 8. Each page is stored as one byte per column,
+ * bit 0 being the top row of the page, and pages follow each other.
+ *
+ * @return The number of bytes written to out.
+ */
+static int pack_columns(const Image *image, int x0, int y0, int width, int height, uint8_t *out) {
+	int pages = (height + 7) / 8;
+	int page, x, bit;
+
+	for(page = 0; page < pages; page++) {
+		for(x = 0; x < width; x++) {
+			uint8_t byte = 0;
+			for(bit = 0; bit < 8 && page * 8 + bit < height; bit++) {
+				byte |= pixel(image, x0 + x, y0 + page * 8 + bit) << bit;
+			}
+			*out++ = byte;
+		}
+	}
+
+	return pages * width;
+}
+
+/**
+ * @brief Run-length encodes packed columns into (skip, count, bytes...) records per page.
+ *
+ * Empty columns are skipped, everything else is stored as literal bytes. A run of
+ * empty columns shorter than 3 inside ink is kept as literals, since a new record
+ * would cost more than the zeros. If out is NULL only the size is computed.
+ *
+ * @return The size of the encoded data in bytes.
+ */
+static int encode_rle(const uint8_t *packed, int width, int pages, uint8_t *out) {
+	int size = 0;
+	int page;
+
+	for(page = 0; page < pages; page++) {
+		const uint8_t *row = packed + page * width;
+		int x = 0;
+
+		while(x < width) {
+			int skip = 0, count = 0, zeros;
+
+			while(x + skip < width && row[x + skip] == 0) {
+				skip++;
+			}
+			x += skip;
+
+			// Extend the literal run over short gaps of empty columns
+			while(x + count < width) {
+				if(row[x + count]) {
+					count++;
+					continue;
+				}
+				zeros = 0;
+				while(x + count + zeros < width && row[x + count + zeros] == 0) {
+					zeros++;
+				}
+				if(zeros < 3 && x + count + zeros < width && count + zeros < 255) {
+					count += zeros;
+				} else {
+					break;
+				}
+			}
+			if(count > 255) {
+				count = 255;
+			}
+
+			if(out) {
+				out[size] = skip;
+				out[size + 1] = count;
+				memcpy(out + size + 2, row + x, count);
+			}
+			size += 2 + count;
+			x += count;
+		}
+	}
+
+	return size;
+}
+
+/**
+ * @brief Writes a byte array as C initializer lines.
+ */
+static void emit_bytes(FILE *out, const uint8_t *bytes, int count) {
+	int i;
+
+	for(i = 0; i < count; i++) {
+		fprintf(out, "%s0x%02x,%s", i % BYTES_PER_LINE ? " " : "\t", bytes[i],
+			(i % BYTES_PER_LINE == BYTES_PER_LINE - 1 || i == count - 1) ? "\n" : "");
+	}
+}
+
+/**
+ * @brief Converts an asset name to the prefix of its constants, e.g. dino1 -> DINO1.
+ */
+static void upper_name(const char *name, char *out) {
+	while(*name) {
+		*out++ = toupper((unsigned char)*name++);
+	}
+	*out = 0;
+}
+
+/**
+ * @brief Looks up a key=value option. Bare options are returned as "".
+ */
+static const char *option(char **options, int count, const char *key) {
+	int i;
+	size_t length = strlen(key);
+
+	for(i = 0; i < count; i++) {
+		if(strncmp(options[i], key, length) == 0) {
+			if(options[i][length] == '=') {
+				return options[i] + length + 1;
+			}
+			if(options[i][length] == 0) {
+				return "";
+			}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Emits a compiled blit function for a sprite.
+ *
+ * Every column of the sprite becomes a constant mask that is shifted to the pixel
+ * row within the page and ORed into the pages it covers. Columns and pages that can
+ * never receive any pixels are left out. The page below the last one of the sprite
+ * is only touched when the shift makes the sprite spill into it, which is decided
+ * once per call. The function assumes that the sprite is completely on screen.
+ *
+ * @return The number of stores in the generated function.
+ */
+static int emit_compiled(FILE *c_out, const char *name, const Image *image) {
+	int pages = (image->height + 7) / 8;
+	int stores = 0;
+	uint32_t *masks = calloc(image->width, sizeof(uint32_t));
+	int x, y, page;
+
+	if(image->height > 24) {
+		fail("%s: compiled sprites are limited to 24 rows", name);
+	}
+
+	for(x = 0; x < image->width; x++) {
+		for(y = 0; y < image->height; y++) {
+			masks[x] |= (uint32_t)pixel(image, x, y) << y;
+		}
+	}
+
+	fprintf(c_out, "/* %s: compiled blit, assumes the sprite is completely on screen */\n", name);
+	fprintf(c_out, "static void %s_blit(int x, int y) {\n", name);
+	fprintf(c_out, "\tuint8_t *p = &pixel_data[y >> 3][x];\n");
+	fprintf(c_out, "\tint s = y & 7;\n\n");
+
+	for(page = 0; page <= pages; page++) {
+		// Mask bits that can end up in this page for any shift 0-7
+		uint32_t window = ((uint32_t)0x7FFF << (8 * page)) >> 7;
+		const char *indent = page == pages ? "\t\t" : "\t";
+
+		if(page == pages) {
+			fprintf(c_out, "\n\tif(s > %d) {\n", 8 * pages - image->height);
+		}
+
+		for(x = 0; x < image->width; x++) {
+			if(!(masks[x] & window)) {
+				continue;
+			}
+			if(page == 0) {
+				fprintf(c_out, "%sp[%d] |= 0x%02xu << s;\n", indent, x, masks[x] & 0xFF);
+			} else {
+				fprintf(c_out, "%sp[%d] |= (0x%04xu << s) >> %d;\n", indent, page * 128 + x,
+					masks[x] & window, 8 * page);
+			}
+			stores++;
+		}
+
+		if(page == pages) {
+			fprintf(c_out, "\t}\n");
+		}
+	}
+
+	fprintf(c_out, "}\n\n");
+	free(masks);
+	return stores;
+}
+
+/**
+ * @brief Emits the 8 pre-shifted copies of a sprite.
+ *
+ * Copy k holds the sprite moved down by k rows, packed into PRESHIFT_PAGES pages
+ * (enough for the largest shift) of one byte per column. The copies follow each
+ * other, so the copy for a given y starts at (y & 7) * pages * width.
+ *
+ * @return The number of bytes emitted.
+ */
+static int emit_preshifted(FILE *c_out, const char *name, const Image *image) {
+	int pages = (image->height + 14) / 8;
+	int copy_size = pages * image->width;
+	int size = 8 * copy_size;
+	uint8_t *shifted = malloc(size);
+	int k;
+
+	for(k = 0; k < 8; k++) {
+		pack_columns(image, 0, -k, image->width, pages * 8, shifted + k * copy_size);
+	}
+
+	fprintf(c_out, "/* %s: 8 pre-shifted copies of %d pages, %d bytes */\n", name, pages, size);
+	fprintf(c_out, "static const uint8_t %s_shifted[%d] = {\n", name, size);
+	emit_bytes(c_out, shifted, size);
+	fprintf(c_out, "};\n\n");
+
+	free(shifted);
+	return size;
+}
+
+/**
+ * @brief Emits the collision mask of a sprite, one word per column with bit y being row y.
+ *
+ * @return The number of bytes emitted.
+ */
+static int emit_mask(FILE *c_out, const char *name, const Image *image) {
+	int x, y;
+
+	if(image->height > 32) {
+		fail("%s: collision masks are limited to 32 rows", name);
+	}
+
+	fprintf(c_out, "/* %s: collision mask, one word per column */\n", name);
+	fprintf(c_out, "static const uint32_t %s_mask[%d] = {\n", name, image->width);
+	for(x = 0; x < image->width; x++) {
+		uint32_t mask = 0;
+		for(y = 0; y < image->height; y++) {
+			mask |= (uint32_t)pixel(image, x, y) << y;
+		}
+		fprintf(c_out, "%s0x%08xu,%s", x % 6 ? " " : "\t", mask,
+			(x % 6 == 5 || x == image->width - 1) ? "\n" : "");
+	}
+	fprintf(c_out, "};\n\n");
+
+	return 4 * image->width;
+}
+
+/**
+ * @brief Emits a sprite descriptor, its data and its size constants.
+ */
+static void emit_sprite(FILE *c_out, FILE *h_out, const char *name, const Image *image,
+		char **options, int option_count) {
+	char upper[MAX_NAME];
+	uint8_t *packed = malloc(image->width * ((image->height + 7) / 8));
+	int compiled = option(options, option_count, "compiled") != NULL;
+	int preshift = option(options, option_count, "preshift") != NULL;
+	int keep_packed = option(options, option_count, "packed") != NULL;
+	int mask = option(options, option_count, "mask") != NULL;
+	int pages = (image->height + 7) / 8;
+	int size, packed_size, stores = 0, shifted_size = 0, mask_size = 0;
+	int rle = 0;
+
+	if(image->width > 255 || image->height > 255) {
+		fail("%s: sprites are limited to 255x255 pixels", name);
+	}
+	if(compiled && preshift) {
+		fail("%s: a sprite is either compiled or pre-shifted, not both", name);
+	}
+
+	upper_name(name, upper);
+	size = packed_size = pack_columns(image, 0, 0, image->width, image->height, packed);
+
+	// The fast paths read the packed columns, so only plain sprites are worth encoding
+	if(!compiled && !preshift && !keep_packed) {
+		int rle_size = encode_rle(packed, image->width, pages, NULL);
+		if(rle_size < packed_size) {
+			uint8_t *encoded = malloc(rle_size);
+			encode_rle(packed, image->width, pages, encoded);
+			free(packed);
+			packed = encoded;
+			size = rle_size;
+			rle = 1;
+		}
+	}
+
+	fprintf(c_out, "/* %s: %dx%d, %s, %d bytes */\n", name, image->width, image->height,
+		rle ? "run-length encoded columns" : "packed columns", size);
+	fprintf(c_out, "static const uint8_t %s_data[%d] = {\n", name, size);
+	emit_bytes(c_out, packed, size);
+	fprintf(c_out, "};\n\n");
+
+	if(compiled) {
+		stores = emit_compiled(c_out, name, image);
+	}
+	if(preshift) {
+		shifted_size = emit_preshifted(c_out, name, image);
+	}
+	if(mask) {
+		mask_size = emit_mask(c_out, name, image);
+	}
+
+	fprintf(c_out, "const Sprite %s = {\n", name);
+	fprintf(c_out, "\t.width = %s_WIDTH,\n", upper);
+	fprintf(c_out, "\t.height = %s_HEIGHT,\n", upper);
+	fprintf(c_out, "\t.encoding = %s,\n", rle ? "SPRITE_RLE" : "SPRITE_PACKED");
+	fprintf(c_out, "\t.data = %s_data,\n", name);
+	if(compiled) {
+		fprintf(c_out, "\t.blit = %s_blit,\n", name);
+	}
+	if(preshift) {
+		fprintf(c_out, "\t.shifted = %s_shifted,\n", name);
+	}
+	if(mask) {
+		fprintf(c_out, "\t.mask = %s_mask,\n", name);
+	}
+	fprintf(c_out, "};\n\n");
+
+	fprintf(h_out, "#define %s_WIDTH %d\n", upper, image->width);
+	fprintf(h_out, "#define %s_HEIGHT %d\n", upper, image->height);
+	fprintf(h_out, "extern const Sprite %s;\n\n", name);
+
+	fprintf(stderr, "assetgen: %-16s %3dx%-3d %s %4d bytes", name, image->width, image->height,
+		rle ? "rle   " : "packed", size);
+	if(rle) {
+		fprintf(stderr, " (packed would be %d)", packed_size);
+	}
+	if(compiled) {
+		fprintf(stderr, ", compiled blit with %d stores", stores);
+	}
+	if(preshift) {
+		fprintf(stderr, ", pre-shifted %d bytes (+%d flash)", shifted_size, shifted_size - size);
+	}
+	if(mask) {
+		fprintf(stderr, ", collision mask %d bytes", mask_size);
+	}
+	fputc('\n', stderr);
+	free(packed);
+
+	if(sprite_count == MAX_SPRITES) {
+		fail("too many sprites");
+	}
+	strcpy(sprites[sprite_count].name, name);
+	sprites[sprite_count].image = *image;
+	sprites[sprite_count].rle = rle;
+	sprite_count++;
+}
+
+/**
+ * @brief Looks up a sprite emitted earlier in the manifest.
+ */
+static const SpriteEntry *find_sprite(const char *name) {
+	int i;
+
+	for(i = 0; i < sprite_count; i++) {
+		if(strcmp(sprites[i].name, name) == 0) {
+			return &sprites[i];
+		}
+	}
+	fail("unknown sprite '%s'", name);
+	return NULL;
+}
+
+/**
+ * @brief Returns whether column x differs between two images of the same size.
+ */
+static int column_differs(const Image *a, const Image *b, int x) {
+	int y;
+
+	for(y = 0; y < a->height; y++) {
+		if(pixel(a, x, y) != pixel(b, x, y)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Emits an animation: its frames and the changed column spans between them.
+ *
+ * For the step into frame i (from frame i - 1, wrapping around) the spans are
+ * stored as a count followed by (first column, number of columns) pairs. Spans
+ * that are only one unchanged column apart are merged, since a separate span
+ * costs more than redrawing that column.
+ */
+static void emit_animation(FILE *c_out, FILE *h_out, const char *name, char **frames, int frame_count) {
+	const SpriteEntry *entries[MAX_FRAMES];
+	uint8_t spans[MAX_FRAMES][1 + 2 * 128];
+	int offsets[MAX_FRAMES];
+	int i, x, total = 0, changed = 0;
+
+	if(frame_count < 2 || frame_count > MAX_FRAMES) {
+		fail("%s: animations need 2 to %d frames", name, MAX_FRAMES);
+	}
+
+	for(i = 0; i < frame_count; i++) {
+		entries[i] = find_sprite(frames[i]);
+		if(entries[i]->rle) {
+			fail("%s: frame %s is run-length encoded, mark it packed, compiled or preshift", name, frames[i]);
+		}
+		if(entries[i]->image.width != entries[0]->image.width || entries[i]->image.height != entries[0]->image.height) {
+			fail("%s: frame %s does not have the size of %s", name, frames[i], frames[0]);
+		}
+	}
+
+	for(i = 0; i < frame_count; i++) {
+		const Image *from = &entries[(i + frame_count - 1) % frame_count]->image;
+		const Image *to = &entries[i]->image;
+		uint8_t *span = spans[i];
+		int count = 0;
+
+		for(x = 0; x < to->width; x++) {
+			if(!column_differs(from, to, x)) {
+				continue;
+			}
+			changed++;
+			if(count && span[2 * count - 1] + span[2 * count] + 1 >= x) {
+				span[2 * count] = x - span[2 * count - 1] + 1;
+			} else {
+				count++;
+				span[2 * count - 1] = x;
+				span[2 * count] = 1;
+			}
+		}
+		span[0] = count;
+		offsets[i] = total;
+		total += 1 + 2 * count;
+	}
+
+	fprintf(c_out, "/* %s: %d frames, changed column spans for the step into each frame */\n", name, frame_count);
+	fprintf(c_out, "static const Sprite *const %s_frames[%d] = {", name, frame_count);
+	for(i = 0; i < frame_count; i++) {
+		fprintf(c_out, "%s&%s", i ? ", " : " ", frames[i]);
+	}
+	fprintf(c_out, " };\n\n");
+
+	fprintf(c_out, "static const uint8_t %s_spans[%d] = {\n", name, total);
+	for(i = 0; i < frame_count; i++) {
+		int j;
+		fprintf(c_out, "\t%d,", spans[i][0]);
+		for(j = 1; j <= 2 * spans[i][0]; j++) {
+			fprintf(c_out, " %d,", spans[i][j]);
+		}
+		fprintf(c_out, " // into %s\n", frames[i]);
+	}
+	fprintf(c_out, "};\n\n");
+
+	fprintf(c_out, "static const uint8_t %s_span_offsets[%d] = {", name, frame_count);
+	for(i = 0; i < frame_count; i++) {
+		fprintf(c_out, "%s%d", i ? ", " : " ", offsets[i]);
+	}
+	fprintf(c_out, " };\n\n");
+
+	fprintf(c_out, "const Animation %s = {\n", name);
+	fprintf(c_out, "\t.frame_count = %d,\n", frame_count);
+	fprintf(c_out, "\t.frames = %s_frames,\n", name);
+	fprintf(c_out, "\t.spans = %s_spans,\n", name);
+	fprintf(c_out, "\t.span_offsets = %s_span_offsets,\n", name);
+	fprintf(c_out, "};\n\n");
+
+	fprintf(h_out, "extern const Animation %s;\n\n", name);
+
+	fprintf(stderr, "assetgen: %-16s %3d frames  delta  %4d bytes, %d of %d columns change per loop\n",
+		name, frame_count, total + frame_count, changed, frame_count * entries[0]->image.width);
+}
+
+/**
+ * @brief Emits a font table with one row of packed columns per glyph.
+ */
+static void emit_font(FILE *c_out, FILE *h_out, const char *name, const Image *image,
+		char **options, int option_count) {
+	const char *cell = option(options, option_count, "cell");
+	const char *count_option = option(options, option_count, "count");
+	char upper[MAX_NAME];
+	uint8_t columns[8];
+	int cell_width, cell_height, per_row, count, i;
+
+	if(!cell || sscanf(cell, "%dx%d", &cell_width, &cell_height) != 2 ||
+			cell_width <= 0 || cell_width > 8 || cell_height <= 0 || cell_height > 8) {
+		fail("%s: fonts need a cell=WxH option of at most 8x8", name);
+	}
+
+	per_row = image->width / cell_width;
+	count = per_row * (image->height / cell_height);
+	if(count_option) {
+		int wanted = atoi(count_option);
+		if(wanted <= 0 || wanted > count) {
+			fail("%s: count=%d does not fit the sheet", name, wanted);
+		}
+		count = wanted;
+	}
+
+	upper_name(name, upper);
+
+	fprintf(c_out, "/* %s: %d glyphs of %dx%d, %d bytes */\n", name, count, cell_width, cell_height,
+		count * cell_width);
+	fprintf(c_out, "const uint8_t %s[%s_GLYPHS][%s_WIDTH] = {\n", name, upper, upper);
+	for(i = 0; i < count; i++) {
+		int x = (i % per_row) * cell_width;
+		int y = (i / per_row) * cell_height;
+		int j;
+
+		pack_columns(image, x, y, cell_width, cell_height, columns);
+		fprintf(c_out, "\t{");
+		for(j = 0; j < cell_width; j++) {
+			fprintf(c_out, "%s0x%02x", j ? ", " : " ", columns[j]);
+		}
+		fprintf(c_out, " },\n");
+	}
+	fprintf(c_out, "};\n\n");
+
+	fprintf(h_out, "#define %s_WIDTH %d\n", upper, cell_width);
+	fprintf(h_out, "#define %s_HEIGHT %d\n", upper, cell_height);
+	fprintf(h_out, "#define %s_GLYPHS %d\n", upper, count);
+	fprintf(h_out, "extern const uint8_t %s[%s_GLYPHS][%s_WIDTH];\n\n", name, upper, upper);
+
+	fprintf(stderr, "assetgen: %-16s %3d glyphs  font   %4d bytes\n", name, count, count * cell_width);
+}
+
+/**
+ * @brief Writes the banner at the top of both generated files.
+ */
+static void emit_banner(FILE *out, const char *file, const char *brief) {
+	fprintf(out,
+		"/**\n"
+		" * @file %s\n"
+		" * @brief %s\n"
+		" *\n"
+		" * Generated by tools/assetgen from %s.\n"
+		" * Do not edit by hand: edit the images in assets/ and run make.\n"
+		" *\n"
+		" * @author Elias Hollstrand\n"
+		" * @author Mattias Kvist\n"
+		" *\n"
+		" * For copyright and licensing, see file COPYING.\n"
+		" */\n\n",
+		file, brief, manifest_path);
+}
+
+/**
+ * @brief Returns the file name part of a path.
+ */
+static const char *base_name(const char *path) {
+	const char *slash = strrchr(path, '/');
+	return slash ? slash + 1 : path;
+}
+
+int main(int argc, char **argv) {
+	char line[MAX_LINE], directory[MAX_PATH], path[MAX_PATH];
+	FILE *manifest, *c_out, *h_out;
+	const char *slash;
+
+	if(argc != 4) {
+		fprintf(stderr, "usage: %s <manifest> <output.c> <output.h>\n", argv[0]);
+		return 1;
+	}
+
+	manifest_path = argv[1];
+	manifest = fopen(manifest_path, "r");
+	if(!manifest) {
+		fprintf(stderr, "assetgen: cannot open %s\n", manifest_path);
+		return 1;
+	}
+
+	// Image paths in the manifest are relative to the manifest itself
+	slash = strrchr(manifest_path, '/');
+	snprintf(directory, sizeof(directory), "%.*s", slash ? (int)(slash - manifest_path + 1) : 0, manifest_path);
+
+	c_out = fopen(argv[2], "w");
+	h_out = fopen(argv[3], "w");
+	if(!c_out || !h_out) {
+		fprintf(stderr, "assetgen: cannot write output files\n");
+		return 1;
+	}
+
+	emit_banner(c_out, base_name(argv[2]), "Graphics data used in the program, generated from the images in assets/.");
+	fprintf(c_out, "#include <stdint.h>\n#include \"declare.h\"\n\n");
+
+	emit_banner(h_out, base_name(argv[3]), "Declarations and dimensions of the graphics in data.c.");
+	fprintf(h_out, "#ifndef DATA_H\n#define DATA_H\n\n");
+
+	while(fgets(line, sizeof(line), manifest)) {
+		char *words[16];
+		int count = 0;
+		char *word;
+		Image image;
+
+		manifest_line++;
+		line[strcspn(line, "#\r\n")] = 0;
+
+		for(word = strtok(line, " \t"); word && count < 16; word = strtok(NULL, " \t")) {
+			words[count++] = word;
+		}
+		if(count == 0) {
+			continue;
+		}
+		if(count < 3) {
+			fail("expected <kind> <name> <file> [options]");
+		}
+		if(strlen(words[1]) >= MAX_NAME) {
+			fail("asset name too long");
+		}
+
+		if(strcmp(words[0], "animation") == 0) {
+			emit_animation(c_out, h_out, words[1], words + 2, count - 2);
+			continue;
+		}
+
+		snprintf(path, sizeof(path), "%s%s", directory, words[2]);
+		load_image(path, &image);
+
+		if(strcmp(words[0], "sprite") == 0) {
+			// The sprite keeps its image, animations compare frames with it
+			emit_sprite(c_out, h_out, words[1], &image, words + 3, count - 3);
+		} else if(strcmp(words[0], "font") == 0) {
+			emit_font(c_out, h_out, words[1], &image, words + 3, count - 3);
+			free(image.pixels);
+		} else {
+			fail("unknown asset kind '%s'", words[0]);
+		}
+	}
+
+	fprintf(h_out, "#endif\n");
+
+	fclose(manifest);
+	fclose(c_out);
+	fclose(h_out);
+	return 0;
+}
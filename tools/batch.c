@@ -0,0 +1,485 @@
+/**
+ * @file batch.c
+ * @brief Batched game engine for the host tools: many games advanced a tick at a time.
+ *
+ * batch_step() does what update_game() does, for every game in the batch at once. The
+ * character and the obstacle move in branch-free code written with the vector extensions
+ * of GCC and clang, so each statement works on BATCH_LANES games whatever the compiler's
+ * own vectorizer makes of it: every if of move_character(), apply_gravity(),
+ * next_character_frame() and the common path of move_obstacle() becomes a mask that
+ * blends the two outcomes, and the same code also does the box test that check_collision()
+ * starts with. Games that are over are moved too, it is cheaper than masking the stores;
+ * they stay in range, as their obstacle stops once it is off the screen.
+ *
+ * The two things that are rare but complicated are left to the code of game.c itself,
+ * so the batch can never play differently from a single game:
+ * - A game whose obstacle has left the screen is passed to pass_obstacle(), which scores,
+ *   advances the difficulty and spawns, and the new obstacle is copied into the arrays.
+ * - A game whose swept boxes overlap, or which has just spawned, is tested pixel by pixel
+ *   with sprites_collide_swept(), the test check_collision() ends with.
+ * Only the blocks of games that have any of these are visited after the vector pass.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "batch.h"
+#include "../data.h"
+
+#define FIELD_COUNT 22    // Number of int16_t arrays in a GameBatch
+#define SPAWN 1           // Marks a game whose obstacle left the screen
+#define HIT 2             // Marks a game whose character may have hit the obstacle
+#define MAX_FALL_TICKS 1000 // A jump that is not back on the ground by then never will be
+
+// BATCH_LANES games side by side. The operators of C work on every lane at once, and a
+// comparison gives all ones in the lanes where it holds and all zeros in the others.
+typedef int16_t Lanes __attribute__((vector_size(BATCH_LANES * sizeof(int16_t))));
+
+// The lanes of a block of one of the arrays of a batch, which are aligned to whole blocks.
+// The arrays are read from a copy of the batch, which the stores to them cannot change.
+typedef Lanes BlockOfLanes __attribute__((may_alias));
+#define LANES(field, block) (*(BlockOfLanes *)(arrays.field + (block) * BATCH_LANES))
+#define SPLAT(value) ((Lanes){0} + (int16_t)(value))
+#define BLEND(mask, a, b) (((a) & (mask)) | ((b) & ~(mask))) // a where the mask is set, b where it is not
+
+// 1 if any of the lanes is not zero
+static inline int any_lane(Lanes lanes) {
+	uint64_t words[sizeof(Lanes) / sizeof(uint64_t)];
+	uint64_t any = 0;
+	unsigned i;
+
+	memcpy(words, &lanes, sizeof(words));
+	for(i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+		any |= words[i];
+	}
+	return any != 0;
+}
+
+/**
+ * @brief Checks that every frame of an animation has the size of the given sprite.
+ */
+static int same_size(const Animation *animation, const Sprite *sprite) {
+	int i;
+
+	for(i = 0; i < animation->frame_count; i++) {
+		if(animation->frames[i]->width != sprite->width || animation->frames[i]->height != sprite->height) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Checks that every value the vector code works out for games of these rules fits in 16 bits.
+ *
+ * The dino gets highest in a jump restarted right below JUMP_CEILING, and falls fastest
+ * coming down from there. An obstacle spawns at most as far out as the dino needs to get
+ * back on the ground and over it, under MAX_JUMP_TICKS ticks at the speed of the obstacle,
+ * which is 6144 pixels even at the most speed that fits.
+ */
+static int fits_in_lanes(const GameRules *rules) {
+	int32_t y = (JUMP_CEILING << 8) + 1;
+	int32_t velocity = rules->jump_velocity;
+	int tick, band, i;
+
+	for(tick = 0; tick < MAX_FALL_TICKS; tick++) {
+		velocity += rules->gravity;
+		if(velocity < INT16_MIN || velocity > INT16_MAX || y + velocity < INT16_MIN || y + velocity > INT16_MAX) {
+			return 0;
+		}
+		if(y + velocity > GROUND_Y << 8) {
+			break;
+		}
+		y += velocity;
+	}
+	if(tick == MAX_FALL_TICKS || rules->jump_velocity < INT16_MIN || rules->gravity > INT16_MAX) {
+		return 0;
+	}
+
+	for(band = 0; band < rules->band_count; band++) {
+		for(i = 0; i < rules->archetype_count; i++) {
+			int speed = (rules->schedule[band].speed * rules->archetypes[i].velocity) >> 8;
+			if(speed < 0 || speed > INT16_MAX) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Creates a batch of games played by the given rules.
+ *
+ * The games are not started, batch_reset() has to be called for each of them first.
+ * The vector code keeps one size per game for the obstacle and one for each action of the
+ * character, so every frame of an animation has to have the size of its first frame, and
+ * an animated obstacle has to spawn with its first frame. Every value it works out has to
+ * fit in 16 bits, which it does unless jumps or obstacles are faster than a screen per tick.
+ *
+ * @param count The number of games.
+ * @param rules The rules, built by build_game_rules(). They are not copied.
+ * @return The batch, or 0 if there is not enough memory or the rules cannot be batched.
+ */
+GameBatch *batch_create(int count, const GameRules *rules) {
+	int i;
+
+	if(!fits_in_lanes(rules) || !same_size(&dino_run, dino_run.frames[0]) || !same_size(&dino_duck, dino_duck.frames[0])) {
+		return 0;
+	}
+	for(i = 0; i < rules->archetype_count; i++) {
+		const ObstacleArchetype *type = &rules->archetypes[i];
+		if(type->animation && (type->animation->frames[0] != type->sprite || !same_size(type->animation, type->sprite))) {
+			return 0;
+		}
+	}
+
+	GameBatch *batch = calloc(1, sizeof(GameBatch));
+	if(!batch) {
+		return 0;
+	}
+	int16_t **fields[FIELD_COUNT] = {
+		&batch->buttons, &batch->game_over,
+		&batch->character_y_q8, &batch->character_x, &batch->character_height, &batch->y_velocity,
+		&batch->action, &batch->character_frame, &batch->dino_frames_passed,
+		&batch->obstacle_x, &batch->obstacle_x_fraction, &batch->obstacle_y, &batch->obstacle_speed,
+		&batch->obstacle_width, &batch->obstacle_height, &batch->obstacle_frame, &batch->obstacle_ticks,
+		&batch->obstacle_period, &batch->obstacle_frame_count, &batch->previous_obstacle_x,
+		&batch->previous_character_y, &batch->previous_character_height,
+	};
+	// Every array starts on a 64 byte boundary, and one cache line further along than a power
+	// of two, so that the arrays do not all map to the same set of the L1 cache
+	int padded = (count + BATCH_LANES - 1) / BATCH_LANES * BATCH_LANES;
+	size_t stride = (padded + 31) / 32 * 32 + 32;
+
+	// One block for all the arrays, so they sit next to each other in memory
+	int16_t *block = aligned_alloc(64, (FIELD_COUNT + 1) * stride * sizeof(int16_t));
+	batch->score = calloc(padded, sizeof(int32_t));
+	batch->games = calloc(count, sizeof(GameContext));
+	batch->event_blocks = calloc(padded / BATCH_LANES, sizeof(int));
+	if(!block || !batch->score || !batch->games || !batch->event_blocks) {
+		free(block);
+		free(batch->score);
+		free(batch->games);
+		free(batch->event_blocks);
+		free(batch);
+		return 0;
+	}
+	memset(block, 0, (FIELD_COUNT + 1) * stride * sizeof(int16_t));
+
+	for(i = 0; i < FIELD_COUNT; i++) {
+		*fields[i] = block + i * stride;
+	}
+	batch->events = block + FIELD_COUNT * stride;
+	for(i = 0; i < padded; i++) {
+		batch->game_over[i] = 1; // Until it is started, and the padding is never played
+	}
+	batch->count = count;
+	batch->blocks = padded / BATCH_LANES;
+	batch->rules = rules;
+	return batch;
+}
+
+void batch_free(GameBatch *batch) {
+	if(batch) {
+		free(batch->buttons); // The start of the block
+		free(batch->score);
+		free(batch->games);
+		free(batch->event_blocks);
+		free(batch);
+	}
+}
+
+// The frames a game is shown (and hit) with, picked the way animate_character() and move_obstacle() pick them
+static const Sprite *character_sprite(int action, int frame) {
+	return (action == DUCKING ? &dino_duck : &dino_run)->frames[frame];
+}
+
+static const Sprite *obstacle_sprite(const ObstacleArchetype *type, int frame) {
+	return type->animation ? type->animation->frames[frame] : type->sprite;
+}
+
+/**
+ * @brief Copies the obstacle of a game into the arrays of the batch.
+ */
+static void store_obstacle(GameBatch *batch, int i, const GameContext *game) {
+	const Animation *animation = game->obstacle_type->animation;
+
+	batch->obstacle_x[i] = game->obstacle_x_q8 >> 8;
+	batch->obstacle_x_fraction[i] = game->obstacle_x_q8 & 255;
+	batch->obstacle_y[i] = game->obstacle_y;
+	batch->obstacle_speed[i] = game->obstacle_speed;
+	batch->obstacle_width[i] = game->obstacle->width;
+	batch->obstacle_height[i] = game->obstacle->height;
+	batch->obstacle_frame[i] = game->obstacle_frame;
+	batch->obstacle_ticks[i] = game->obstacle_ticks;
+	batch->obstacle_period[i] = game->obstacle_type->animation_period;
+	batch->obstacle_frame_count[i] = animation ? animation->frame_count : 0;
+	batch->score[i] = game->score;
+}
+
+/**
+ * @brief Copies the arrays of one game of a batch into a GameContext holding the rest of it.
+ */
+static void load_lane(const GameBatch *batch, int i, GameContext *game) {
+	game->character_y_q8 = batch->character_y_q8[i];
+	game->character_y = game->character_y_q8 >> 8;
+	game->character_x = batch->character_x[i];
+	game->character_height = batch->character_height[i];
+	game->y_velocity = batch->y_velocity[i];
+	game->action = batch->action[i];
+	game->character_frame = batch->character_frame[i];
+	game->dino_frames_passed = batch->dino_frames_passed[i];
+	game->character_animation = game->action == DUCKING ? &dino_duck : &dino_run;
+	game->character = character_sprite(game->action, game->character_frame);
+
+	game->obstacle_x_q8 = batch->obstacle_x[i] * 256 + batch->obstacle_x_fraction[i];
+	game->obstacle_x = batch->obstacle_x[i];
+	game->obstacle_y = batch->obstacle_y[i];
+	game->obstacle_speed = batch->obstacle_speed[i];
+	game->obstacle_frame = batch->obstacle_frame[i];
+	game->obstacle_ticks = batch->obstacle_ticks[i];
+	game->obstacle = obstacle_sprite(game->obstacle_type, game->obstacle_frame);
+
+	game->previous_obstacle_x = batch->previous_obstacle_x[i];
+	game->previous_character_y = batch->previous_character_y[i];
+	game->previous_character_height = batch->previous_character_height[i];
+	game->score = batch->score[i];
+	game->game_over = batch->game_over[i];
+}
+
+/**
+ * @brief Copies one game of a batch into a GameContext.
+ *
+ * A game that is over is copied as it was when it ended.
+ *
+ * @param batch The batch.
+ * @param index The game to copy.
+ * @param game Where to copy it to.
+ */
+void batch_load(const GameBatch *batch, int index, GameContext *game) {
+	*game = batch->games[index];
+	if(!batch->game_over[index]) {
+		load_lane(batch, index, game);
+	}
+}
+
+/**
+ * @brief Copies a GameContext into one game of a batch.
+ *
+ * @param batch The batch.
+ * @param index The game to replace.
+ * @param game The game to copy, played by the rules of the batch.
+ */
+void batch_store(GameBatch *batch, int index, const GameContext *game) {
+	int i = index;
+
+	batch->games[i] = *game;
+
+	batch->character_y_q8[i] = game->character_y_q8;
+	batch->character_x[i] = game->character_x;
+	batch->character_height[i] = game->character_height;
+	batch->y_velocity[i] = game->y_velocity;
+	batch->action[i] = game->action;
+	batch->character_frame[i] = game->character_frame;
+	batch->dino_frames_passed[i] = game->dino_frames_passed;
+
+	store_obstacle(batch, i, game);
+
+	batch->previous_obstacle_x[i] = game->previous_obstacle_x;
+	batch->previous_character_y[i] = game->previous_character_y;
+	batch->previous_character_height[i] = game->previous_character_height;
+	batch->game_over[i] = game->game_over;
+}
+
+/**
+ * @brief Starts a new game in one slot of a batch, like reset_game() does for one game.
+ *
+ * @param batch The batch.
+ * @param index The game to start.
+ * @param seed The seed of the new game.
+ */
+void batch_reset(GameBatch *batch, int index, uint32_t seed) {
+	GameContext game;
+
+	reset_game(&game, batch->rules, seed);
+	batch_store(batch, index, &game);
+}
+
+/**
+ * @brief Moves the character and the obstacle of every game, BATCH_LANES games at a time.
+ *
+ * Games whose obstacle has left the screen are marked SPAWN, games whose boxes swept into
+ * each other HIT. Games that are over are never marked, and blocks of them are skipped.
+ *
+ * @return The number of blocks with marked games, listed in event_blocks.
+ */
+static int step_lanes(GameBatch *batch) {
+	const GameBatch arrays = *batch;
+	const Lanes jump_velocity = SPLAT(batch->rules->jump_velocity);
+	const Lanes gravity = SPLAT(batch->rules->gravity);
+	const Lanes run_width = SPLAT(dino_run.frames[0]->width);
+	const Lanes run_height = SPLAT(dino_run.frames[0]->height);
+	const Lanes duck_width = SPLAT(dino_duck.frames[0]->width);
+	const Lanes duck_height = SPLAT(dino_duck.frames[0]->height);
+	int pending = 0;
+	int block;
+
+	for(block = 0; block < arrays.blocks; block++) {
+		Lanes live = LANES(game_over, block) == 0;
+		if(!any_lane(live)) {
+			continue;
+		}
+		Lanes buttons = LANES(buttons, block);
+		Lanes y = LANES(character_y_q8, block);
+		Lanes velocity = LANES(y_velocity, block);
+		Lanes height = LANES(character_height, block);
+		Lanes action = LANES(action, block);
+		Lanes from_y = y >> 8;
+		Lanes from_height = height;
+
+		// move_character(): jump, duck or stand up
+		Lanes duck_held = buttons == BTN3;
+		Lanes jump = (buttons == BTN4) & (y > (JUMP_CEILING << 8)) & ~(velocity > 0);
+		Lanes ducks = duck_held & (from_y + height == GROUND_Y) & ~jump;
+		Lanes stands = (height == DINO_DUCKING1_HEIGHT) & ~(duck_held | jump);
+
+		velocity = BLEND(jump, jump_velocity, velocity);
+		height = BLEND(ducks, SPLAT(DINO_DUCKING1_HEIGHT), BLEND(stands, SPLAT(DINO1_HEIGHT), height));
+		y = BLEND(ducks, SPLAT((GROUND_Y - DINO_DUCKING1_HEIGHT) << 8), y);
+		action = BLEND(ducks, SPLAT(DUCKING), action & ~(jump | stands)); // RUNNING is 0
+
+		// apply_gravity()
+		Lanes ground = (GROUND_Y - height) << 8;
+		velocity += gravity;
+		y += velocity;
+		Lanes land = y > ground;
+		y = BLEND(land, ground, y);
+		velocity &= ~land;
+
+		// next_character_frame()
+		Lanes passed = LANES(dino_frames_passed, block);
+		Lanes frame = (passed > 5) & 1;
+		passed = (passed + 1) & (passed < 9);
+
+		// move_obstacle() while the obstacle is on the screen, in whole pixels and a fraction
+		Lanes from_x = LANES(obstacle_x, block);
+		Lanes width = LANES(obstacle_width, block);
+		Lanes ticks = LANES(obstacle_ticks, block);
+		Lanes obstacle = LANES(obstacle_frame, block);
+		Lanes on_screen = from_x + width > 0;
+		Lanes speed = LANES(obstacle_speed, block) & on_screen;
+		Lanes fraction = LANES(obstacle_x_fraction, block) - (speed & 255);
+		Lanes borrow = fraction < 0;
+		Lanes to_x = from_x - (speed >> 8) + borrow; // A mask is -1 where it is set
+		Lanes animated = on_screen & (LANES(obstacle_frame_count, block) > 0);
+		Lanes turn = animated & (ticks + 1 == LANES(obstacle_period, block));
+		Lanes wrap = obstacle + 1 == LANES(obstacle_frame_count, block);
+
+		fraction += borrow & 256;
+		ticks = (ticks - animated) & ~turn;
+		obstacle = (obstacle - turn) & ~(turn & wrap);
+
+		// check_collision(): did the boxes swept this tick overlap? The obstacle only moves left
+		Lanes to_y = y >> 8;
+		Lanes sweep_y = BLEND(height == from_height, from_y, to_y);
+		Lanes rising = to_y < sweep_y;
+		Lanes top = BLEND(rising, to_y, sweep_y);
+		Lanes bottom = BLEND(rising, sweep_y, to_y);
+		Lanes ducking = action == DUCKING;
+		Lanes character_width = BLEND(ducking, duck_width, run_width);
+		Lanes character_height = BLEND(ducking, duck_height, run_height);
+		Lanes character_x = LANES(character_x, block);
+		Lanes obstacle_y = LANES(obstacle_y, block);
+		Lanes overlap = (from_x + width > character_x) & (character_x + character_width > to_x) &
+			(obstacle_y + LANES(obstacle_height, block) > top) & (bottom + character_height > obstacle_y);
+		Lanes events = live & BLEND(on_screen, overlap & HIT, SPLAT(SPAWN));
+
+		LANES(character_y_q8, block) = y;
+		LANES(y_velocity, block) = velocity;
+		LANES(character_height, block) = height;
+		LANES(action, block) = action;
+		LANES(character_frame, block) = frame;
+		LANES(dino_frames_passed, block) = passed;
+		LANES(obstacle_x, block) = to_x;
+		LANES(obstacle_x_fraction, block) = fraction;
+		LANES(obstacle_ticks, block) = ticks;
+		LANES(obstacle_frame, block) = obstacle;
+		LANES(previous_obstacle_x, block) = from_x;
+		LANES(previous_character_y, block) = from_y;
+		LANES(previous_character_height, block) = from_height;
+		LANES(events, block) = events;
+
+		// List the block if any of its games is marked, without a branch
+		arrays.event_blocks[pending] = block;
+		pending += any_lane(events);
+	}
+	return pending;
+}
+
+/**
+ * @brief Does the rest of update_game() for one marked game.
+ *
+ * @return 1 if the game ended this tick, 0 otherwise.
+ */
+static int finish_game(GameBatch *batch, int i) {
+	GameContext *game = &batch->games[i];
+
+	if(batch->events[i] & SPAWN) {
+		pass_obstacle(game);
+		store_obstacle(batch, i, game);
+	}
+
+	int x = batch->obstacle_x[i];
+	int y = batch->character_y_q8[i] >> 8;
+	int from_x = batch->previous_obstacle_x[i];
+	int from_y = batch->previous_character_y[i];
+
+	if(x > from_x) { // A new obstacle was spawned, it did not sweep anything
+		from_x = x;
+	}
+	if(batch->character_height[i] != batch->previous_character_height[i]) { // Ducked or stood up
+		from_y = y;
+	}
+	if(!sprites_collide_swept(batch->character_x[i], from_y, y - from_y,
+			character_sprite(batch->action[i], batch->character_frame[i]),
+			from_x, batch->obstacle_y[i], x - from_x, obstacle_sprite(game->obstacle_type, batch->obstacle_frame[i]))) {
+		return 0;
+	}
+
+	// Keep the whole game as it ended, its arrays are moved on from here
+	batch->game_over[i] = 1;
+	load_lane(batch, i, game);
+	return 1;
+}
+
+/**
+ * @brief Advances every game of a batch by one tick, like update_game() does for one game.
+ *
+ * Games that are over stay over. Of their arrays only game_over and score still hold their
+ * state, batch_load() returns the rest as it was when they ended. Check game_over to see
+ * which games are done, and restart them with batch_reset().
+ *
+ * @param batch The games, with the buttons held down in each game this tick in buttons.
+ * @return The number of games that ended this tick.
+ */
+int batch_step(GameBatch *batch) {
+	int pending = step_lanes(batch);
+	int ended = 0;
+	int n, i;
+
+	// Only a few games need the rest of update_game()
+	for(n = 0; n < pending; n++) {
+		int first = batch->event_blocks[n] * BATCH_LANES;
+
+		for(i = first; i < first + BATCH_LANES; i++) {
+			if(batch->events[i]) {
+				ended += finish_game(batch, i);
+			}
+		}
+	}
+	return ended;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file batch.h
+ * @brief Declarations for the batched game engine of the host tools.
+ *
+ * A GameBatch holds many games played by the same rules, with the state that changes
+ * every tick stored as one array per field (structure of arrays), so batch_step() can
+ * advance BATCH_LANES games with every vector instruction. These fields all fit in 16
+ * bits; the x of the obstacle, which does not, is kept as whole pixels and a fraction.
+ * The rest of each game is kept in a GameContext that is only touched on the rare ticks
+ * when a game passes its obstacle or may have hit it.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>
+#include "../declare.h"
+
+// Games advanced by one vector instruction: as many 16-bit lanes as the widest vectors
+// the compiler was told it can use, 128 bits on every x86-64 and ARM64 CPU
+#ifdef __AVX2__
+#define BATCH_LANES 16
+#else
+#define BATCH_LANES 8
+#endif
+
+typedef struct {
+	int count;
+	int blocks;             // Blocks of BATCH_LANES games, the last padded with games that are over
+	const GameRules *rules; // Shared by every game in the batch
+
+	// Set before batch_step(): the buttons held down in each game this tick
+	int16_t *buttons;
+
+	// The done flag and the score of each game
+	int16_t *game_over;
+	int32_t *score;
+
+	// The character
+	int16_t *character_y_q8;
+	int16_t *character_x;
+	int16_t *character_height;
+	int16_t *y_velocity;
+	int16_t *action;
+	int16_t *character_frame;
+	int16_t *dino_frames_passed;
+
+	// The obstacle, with the size and animation of its archetype copied in when it spawns
+	int16_t *obstacle_x;
+	int16_t *obstacle_x_fraction;  // obstacle_x_q8 is obstacle_x * 256 + obstacle_x_fraction
+	int16_t *obstacle_y;
+	int16_t *obstacle_speed;
+	int16_t *obstacle_width;
+	int16_t *obstacle_height;
+	int16_t *obstacle_frame;
+	int16_t *obstacle_ticks;
+	int16_t *obstacle_period;      // Ticks per animation frame
+	int16_t *obstacle_frame_count; // 0 if the obstacle is not animated
+
+	// Positions at the start of the tick, for the swept collision test
+	int16_t *previous_obstacle_x;
+	int16_t *previous_character_y;
+	int16_t *previous_character_height;
+
+	int16_t *events;    // What each game needs from the rest of update_game() this tick
+	int *event_blocks;  // The blocks with any events this tick
+	GameContext *games; // Everything else of each game, and all of a game that is over
+} GameBatch;
+
+GameBatch *batch_create(int count, const GameRules *rules);
+void batch_free(GameBatch *batch);
+void batch_reset(GameBatch *batch, int index, uint32_t seed);
+void batch_load(const GameBatch *batch, int index, GameContext *game);
+void batch_store(GameBatch *batch, int index, const GameContext *game);
+int batch_step(GameBatch *batch);
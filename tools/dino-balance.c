@@ -0,0 +1,453 @@
+/**
+ * @file dino-balance.c
+ * @brief Host tool that plays huge numbers of games on all cores to tune the game's balance.
+ *
+ * Every set of rules to try is one line of a parameter file, starting with a name and
+ * followed by the settings that differ from the rules played on the ChipKIT:
+ *
+ *     # name   settings
+ *     default
+ *     floaty   jump=-900 gravity=80
+ *     fast     speed=125 weights=100,100,150,150
+ *
+ * jump and gravity are in 1/256 pixels per tick (per tick), speed scales every speed
+ * of the difficulty schedule and weights scales the spawn weights of each archetype,
+ * both in percent. A set whose weights leave some difficulty level with nothing to
+ * spawn is rejected. Without a parameter file only the default rules are played.
+ *
+ * Every set plays -n games, game i with seed -s plus i, so all sets meet the same
+ * obstacles as far as their rules allow. The games are played by the autopilot of the
+ * attract mode (see autopilot.c), which ducks under what it can duck under and otherwise
+ * jumps on the last tick that clears the obstacle, here pressing it up to -j ticks too
+ * early or too late. An autopilot that is never off may never die, so games also end
+ * after -t ticks.
+ *
+ * The (set, game) jobs are split evenly over -p worker threads. A worker takes jobs
+ * from the front of its own range, and a worker whose range is empty steals the back
+ * half of the largest remaining range, so all workers stay busy until the end. Every
+ * worker adds its results to its own histograms, which are summed once all jobs are
+ * done, so the workers never share anything they write to.
+ *
+ * A summary of every set is written to standard output as CSV. With -H the histograms
+ * of the survival time (in ticks, bins doubling in size) and of the score (bins of -b
+ * points) are written to a second CSV file.
+ *
+ * Usage: dino-balance [-n games] [-s seed] [-t ticks] [-j jitter] [-p threads]
+ *                     [-b bin] [-H histograms.csv] [parameters]
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../declare.h"
+
+#define MAX_SETS 256
+#define MAX_LINE 512
+#define MAX_NAME 32
+#define MAX_BANDS 32
+#define TICK_BINS 32  // Bin k holds survival times in [2^k, 2^(k+1)) ticks
+#define SCORE_BINS 64 // The last bin also holds every higher score
+#define MAX_WEIGHT 25500 // Percent that takes every default weight to the most a weight can be, 255
+
+typedef struct {
+	char name[MAX_NAME];
+	int speed;   // Percent of the default speeds
+	int weights[MAX_ARCHETYPES]; // Percent of the default weights
+	ObstacleArchetype archetypes[MAX_ARCHETYPES];
+	DifficultyBand schedule[MAX_BANDS];
+	GameRules rules;
+} ParameterSet;
+
+typedef struct {
+	uint64_t games;
+	uint64_t censored; // Games still running after max_ticks
+	uint64_t ticks;
+	uint64_t score;
+	int max_score;
+	uint64_t tick_histogram[TICK_BINS];
+	uint64_t score_histogram[SCORE_BINS];
+} SetStats;
+
+typedef struct {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	long next; // Jobs [next, end) are still to be played
+	long end;
+	SetStats *stats;
+} Worker;
+
+ParameterSet sets[MAX_SETS];
+int set_count;
+
+Worker *workers;
+int worker_count;
+
+long games_per_set = 10000;
+uint32_t first_seed = 1;
+uint64_t max_ticks = 100000;
+int jitter = 2;
+int score_bin = 10;
+
+// The game logic draws nothing, but game.c also holds the display code
+int highscore;
+void display_objects(void) {}
+
+/**
+ * @brief Builds the rules of a parameter set from the default rules and its settings.
+ */
+static void build_set(ParameterSet *set, int jump, int gravity) {
+	int i, level;
+
+	set->rules = game_rules;
+	set->rules.jump_velocity = jump;
+	set->rules.gravity = gravity;
+
+	for(i = 0; i < game_rules.archetype_count; i++) {
+		set->archetypes[i] = game_rules.archetypes[i];
+		for(level = 0; level < DIFFICULTY_LEVELS; level++) {
+			int weight = set->archetypes[i].weights[level] * set->weights[i] / 100;
+			set->archetypes[i].weights[level] = weight > 255 ? 255 : weight;
+		}
+	}
+	for(i = 0; i < game_rules.band_count; i++) {
+		int speed = game_rules.schedule[i].speed * set->speed / 100;
+		set->schedule[i] = game_rules.schedule[i];
+		set->schedule[i].speed = speed < 1 ? 1 : speed > 65535 ? 65535 : speed;
+	}
+	set->rules.archetypes = set->archetypes;
+	set->rules.schedule = set->schedule;
+
+	build_game_rules(&set->rules);
+}
+
+/**
+ * @brief Reads the parameter sets from a file, one set per line.
+ */
+static void load_sets(const char *path) {
+	FILE *file = fopen(path, "r");
+	char line[MAX_LINE];
+	int number = 0;
+
+	if(!file) {
+		fprintf(stderr, "dino-balance: cannot open %s\n", path);
+		exit(1);
+	}
+
+	while(fgets(line, sizeof(line), file)) {
+		char *comment = strchr(line, '#');
+		char *word;
+		number++;
+
+		if(comment) {
+			*comment = 0;
+		}
+		word = strtok(line, " \t\r\n");
+		if(!word) {
+			continue;
+		}
+		if(set_count == MAX_SETS) {
+			fprintf(stderr, "%s:%d: more than %d parameter sets\n", path, number, MAX_SETS);
+			exit(1);
+		}
+
+		ParameterSet *set = &sets[set_count++];
+		int jump = game_rules.jump_velocity, gravity = game_rules.gravity;
+		int i;
+
+		snprintf(set->name, sizeof(set->name), "%s", word);
+		set->speed = 100;
+		for(i = 0; i < MAX_ARCHETYPES; i++) {
+			set->weights[i] = 100;
+		}
+
+		while((word = strtok(0, " \t\r\n"))) {
+			if(!strncmp(word, "jump=", 5)) {
+				jump = atoi(word + 5);
+			} else if(!strncmp(word, "gravity=", 8)) {
+				gravity = atoi(word + 8);
+			} else if(!strncmp(word, "speed=", 6)) {
+				set->speed = atoi(word + 6);
+			} else if(!strncmp(word, "weights=", 8)) {
+				char *value = word + 8;
+				for(i = 0; i < game_rules.archetype_count && *value; i++) {
+					char *end;
+					long weight = strtol(value, &end, 10);
+					if(end == value || (*end && *end != ',') || weight < 0 || weight > MAX_WEIGHT) {
+						fprintf(stderr, "%s:%d: weights must be percentages from 0 to %d\n", path, number, MAX_WEIGHT);
+						exit(1);
+					}
+					set->weights[i] = weight;
+					value = *end == ',' ? end + 1 : end;
+				}
+				if(*value) {
+					fprintf(stderr, "%s:%d: more weights than the %d archetypes\n", path, number, game_rules.archetype_count);
+					exit(1);
+				}
+			} else {
+				fprintf(stderr, "%s:%d: unknown setting %s\n", path, number, word);
+				exit(1);
+			}
+		}
+
+		if(jump >= 0 || gravity <= 0 || set->speed <= 0) {
+			fprintf(stderr, "%s:%d: jump must be negative, gravity and speed positive\n", path, number);
+			exit(1);
+		}
+		build_set(set, jump, gravity);
+		for(i = 0; i < DIFFICULTY_LEVELS; i++) {
+			if(set->rules.obstacle_tables[i].count == 0) {
+				fprintf(stderr, "%s:%d: the weights leave nothing to spawn at difficulty level %d\n", path, number, i);
+				exit(1);
+			}
+		}
+		if(set->rules.jump_arcs[JUMP_HELD].ticks == MAX_JUMP_TICKS) {
+			fprintf(stderr, "%s:%d: warning: a jump lasts more than %d ticks, the clearance tables are cut short\n",
+				path, number, MAX_JUMP_TICKS);
+		}
+	}
+
+	fclose(file);
+}
+
+/**
+ * @brief Plays one game and adds its result to the statistics of its set.
+ */
+static void play(long job, SetStats *stats) {
+	ParameterSet *set = &sets[job / games_per_set];
+	uint32_t seed = first_seed + job % games_per_set;
+	GameContext game;
+	Autopilot pilot;
+	uint64_t tick;
+
+	reset_game(&game, &set->rules, seed);
+	autopilot_reset(&pilot, &game, jitter);
+
+	for(tick = 0; tick < max_ticks && !game.game_over; tick++) {
+		update_game(&game, autopilot_buttons(&pilot, &game));
+	}
+
+	int bin = 0;
+	while(bin < TICK_BINS - 1 && tick >> (bin + 1)) {
+		bin++;
+	}
+	int score_index = game.score / score_bin;
+
+	stats->games++;
+	stats->censored += !game.game_over;
+	stats->ticks += tick;
+	stats->score += game.score;
+	if(game.score > stats->max_score) {
+		stats->max_score = game.score;
+	}
+	stats->tick_histogram[bin]++;
+	stats->score_histogram[score_index < SCORE_BINS ? score_index : SCORE_BINS - 1]++;
+}
+
+/**
+ * @brief Takes the next job of a worker, stealing half of the largest remaining range when it has none.
+ *
+ * @return The job to play, or -1 when every job has been taken.
+ */
+static long next_job(Worker *self) {
+	long job = -1;
+
+	pthread_mutex_lock(&self->lock);
+	if(self->next < self->end) {
+		job = self->next++;
+	}
+	pthread_mutex_unlock(&self->lock);
+
+	while(job < 0) {
+		Worker *victim = 0;
+		long most = 0;
+		int i;
+
+		for(i = 0; i < worker_count; i++) {
+			if(&workers[i] == self) {
+				continue;
+			}
+			pthread_mutex_lock(&workers[i].lock);
+			long left = workers[i].end - workers[i].next;
+			pthread_mutex_unlock(&workers[i].lock);
+			if(left > most) {
+				most = left;
+				victim = &workers[i];
+			}
+		}
+		if(!victim) {
+			return -1;
+		}
+
+		// The victim may have played some of its jobs since it was picked
+		long begin = 0, end = 0;
+		pthread_mutex_lock(&victim->lock);
+		long left = victim->end - victim->next;
+		if(left > 0) {
+			end = victim->end;
+			begin = end - (left + 1) / 2;
+			victim->end = begin;
+		}
+		pthread_mutex_unlock(&victim->lock);
+
+		// Only one lock is held at a time, so two workers stealing from each other cannot deadlock
+		if(begin < end) {
+			job = begin;
+			pthread_mutex_lock(&self->lock);
+			self->next = begin + 1;
+			self->end = end;
+			pthread_mutex_unlock(&self->lock);
+		}
+	}
+	return job;
+}
+
+static void *work(void *argument) {
+	Worker *self = argument;
+	long job;
+
+	while((job = next_job(self)) >= 0) {
+		play(job, &self->stats[job / games_per_set]);
+	}
+	return 0;
+}
+
+static double seconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv) {
+	const char *histogram_path = 0;
+	int option, i, s, bin;
+
+	worker_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	while((option = getopt(argc, argv, "n:s:t:j:p:b:H:")) != -1) {
+		switch(option) {
+		case 'n': games_per_set = strtol(optarg, 0, 0); break;
+		case 's': first_seed = strtoul(optarg, 0, 0); break;
+		case 't': max_ticks = strtoull(optarg, 0, 0); break;
+		case 'j': jitter = atoi(optarg); break;
+		case 'p': worker_count = atoi(optarg); break;
+		case 'b': score_bin = atoi(optarg); break;
+		case 'H': histogram_path = optarg; break;
+		default:
+			fprintf(stderr, "usage: %s [-n games] [-s seed] [-t ticks] [-j jitter] [-p threads]\n"
+				"       [-b bin] [-H histograms.csv] [parameters]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(games_per_set < 1 || worker_count < 1 || score_bin < 1 || jitter < 0) {
+		fprintf(stderr, "dino-balance: games, threads and bin must be positive, jitter not negative\n");
+		return 1;
+	}
+
+	build_game_rules(&game_rules);
+	if(game_rules.band_count > MAX_BANDS) {
+		fprintf(stderr, "dino-balance: the difficulty schedule has more than %d bands\n", MAX_BANDS);
+		return 1;
+	}
+
+	if(optind < argc) {
+		load_sets(argv[optind]);
+	} else {
+		snprintf(sets[0].name, sizeof(sets[0].name), "default");
+		sets[0].speed = 100;
+		for(i = 0; i < MAX_ARCHETYPES; i++) {
+			sets[0].weights[i] = 100;
+		}
+		build_set(&sets[0], game_rules.jump_velocity, game_rules.gravity);
+		set_count = 1;
+	}
+
+	// Split the jobs evenly, every worker getting its own statistics
+	long jobs = set_count * games_per_set;
+	workers = calloc(worker_count, sizeof(Worker));
+	for(i = 0; i < worker_count; i++) {
+		pthread_mutex_init(&workers[i].lock, 0);
+		workers[i].next = jobs * i / worker_count;
+		workers[i].end = jobs * (i + 1) / worker_count;
+		workers[i].stats = calloc(set_count, sizeof(SetStats));
+	}
+
+	double start = seconds();
+	for(i = 0; i < worker_count; i++) {
+		pthread_create(&workers[i].thread, 0, work, &workers[i]);
+	}
+	for(i = 0; i < worker_count; i++) {
+		pthread_join(workers[i].thread, 0);
+	}
+	double elapsed = seconds() - start;
+
+	// Sum the statistics of all workers into the first
+	SetStats *total = workers[0].stats;
+	uint64_t total_ticks = 0;
+	for(s = 0; s < set_count; s++) {
+		for(i = 1; i < worker_count; i++) {
+			SetStats *part = &workers[i].stats[s];
+			total[s].games += part->games;
+			total[s].censored += part->censored;
+			total[s].ticks += part->ticks;
+			total[s].score += part->score;
+			if(part->max_score > total[s].max_score) {
+				total[s].max_score = part->max_score;
+			}
+			for(bin = 0; bin < TICK_BINS; bin++) {
+				total[s].tick_histogram[bin] += part->tick_histogram[bin];
+			}
+			for(bin = 0; bin < SCORE_BINS; bin++) {
+				total[s].score_histogram[bin] += part->score_histogram[bin];
+			}
+		}
+		total_ticks += total[s].ticks;
+	}
+
+	printf("set,name,jump,gravity,speed,games,censored,mean_ticks,mean_score,max_score\n");
+	for(s = 0; s < set_count; s++) {
+		printf("%d,%s,%d,%d,%d,%llu,%llu,%.2f,%.3f,%d\n", s, sets[s].name,
+			sets[s].rules.jump_velocity, sets[s].rules.gravity, sets[s].speed,
+			(unsigned long long)total[s].games, (unsigned long long)total[s].censored,
+			(double)total[s].ticks / total[s].games, (double)total[s].score / total[s].games,
+			total[s].max_score);
+	}
+
+	if(histogram_path) {
+		FILE *out = fopen(histogram_path, "w");
+		if(!out) {
+			fprintf(stderr, "dino-balance: cannot write %s\n", histogram_path);
+			return 1;
+		}
+		fprintf(out, "set,name,metric,bin_start,bin_end,count\n");
+		for(s = 0; s < set_count; s++) {
+			for(bin = 0; bin < TICK_BINS; bin++) {
+				if(total[s].tick_histogram[bin]) {
+					fprintf(out, "%d,%s,ticks,%llu,%llu,%llu\n", s, sets[s].name,
+						bin ? 1ULL << bin : 0ULL, (1ULL << (bin + 1)) - 1,
+						(unsigned long long)total[s].tick_histogram[bin]);
+				}
+			}
+			for(bin = 0; bin < SCORE_BINS; bin++) {
+				if(total[s].score_histogram[bin]) {
+					fprintf(out, "%d,%s,score,%d,%d,%llu\n", s, sets[s].name,
+						bin * score_bin, bin == SCORE_BINS - 1 ? -1 : (bin + 1) * score_bin - 1,
+						(unsigned long long)total[s].score_histogram[bin]);
+				}
+			}
+		}
+		fclose(out);
+	}
+
+	fprintf(stderr, "dino-balance: %ld games, %llu ticks on %d threads in %.2f s (%.0f ticks/sec)\n",
+		jobs, (unsigned long long)total_ticks, worker_count, elapsed, total_ticks / elapsed);
+	return 0;
+}
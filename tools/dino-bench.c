@@ -0,0 +1,292 @@
+/**
+ * @file dino-bench.c
+ * @brief Host tool that times the drawing primitives and compares the results.
+ *
+ * The tool links the real display.c and data.c with bench.c, which times every drawing
+ * primitive at a few positions, once for each way the drawing code has of drawing it and
+ * once for a reference that sets one pixel at a time (see bench.c). The host has no
+ * display, so display_objects() only copies the dirty spans into a buffer; its time on the
+ * host is that of the bookkeeping, not of sending the frame.
+ *
+ * The times on the host are in nanoseconds per call. Cycles are only shown when the clock
+ * speed of the host is given with -c, in MHz. The firmware built with make BENCH=1 runs
+ * the same cases at power-up and sends the lines over the UART, with cycles counted by the
+ * CP0 Count register. With -r the tool reads such lines, saved from a terminal, instead of
+ * timing anything, so the board's results are shown and compared the same way.
+ *
+ * The results are printed as a table, each variant of a case with how many times faster
+ * than the reference it is. With -l they are printed as the lines bench.c sends instead,
+ * one case per line, for keeping as a baseline:
+ *
+ *     bench <primitive> <subject> <variant> <x> <y> <cycles per call> <ns per call> ok
+ *
+ * A variant that did not draw the same pixels as the reference is marked BAD, in the table
+ * too, and makes the tool exit with 1. With -b the results are compared with such a
+ * baseline, by cycles when both have them and by nanoseconds otherwise. A case that got
+ * more than -t percent (10 by default) slower is reported, and the tool exits with 1 if
+ * any did.
+ *
+ * Usage: dino-bench [-n calls] [-c MHz] [-r results] [-b baseline] [-t percent] [-l]
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../declare.h"
+
+#define MAX_RESULTS 1024
+#define NAME_BYTES 24
+
+typedef struct {
+	char primitive[NAME_BYTES];
+	char subject[NAME_BYTES];
+	char variant[NAME_BYTES];
+	int x;
+	int y;
+	double cycles; // Per call, or -1 if not known
+	double ns;     // Per call
+	char check[NAME_BYTES]; // "ok", "BAD", or "-" if there was nothing to check against
+} BenchResult;
+
+typedef struct {
+	BenchResult results[MAX_RESULTS];
+	int count;
+} BenchResults;
+
+BenchResults measured;
+BenchResults baseline;
+
+// What display_objects() would have sent
+uint8_t screen[4][128];
+
+/**
+ * @brief Copies the dirty spans into the screen buffer, like sending them without a display.
+ */
+void display_objects(void) {
+	int page, x;
+
+	for(page = 0; page < 4; page++) {
+		for(x = dirty_start[page]; x < dirty_end[page]; x++) {
+			screen[page][x] = pixel_data[page][x];
+		}
+		dirty_start[page] = 128;
+		dirty_end[page] = 0;
+	}
+}
+
+static uint32_t read_ns(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000000000ULL + now.tv_nsec);
+}
+
+/**
+ * @brief Reads one line of results into a list, ignoring lines that are not results.
+ */
+static void parse_line(BenchResults *list, const char *line) {
+	BenchResult *result = &list->results[list->count];
+	char cycles[NAME_BYTES];
+
+	if(list->count == MAX_RESULTS) {
+		fprintf(stderr, "dino-bench: more than %d results\n", MAX_RESULTS);
+		exit(1);
+	}
+	strcpy(result->check, "-");
+	if(sscanf(line, "bench %23s %23s %23s %d %d %23s %lf %23s", result->primitive, result->subject, result->variant,
+		&result->x, &result->y, cycles, &result->ns, result->check) < 7) {
+		return;
+	}
+	result->cycles = strcmp(cycles, "-") ? atof(cycles) : -1;
+	list->count++;
+}
+
+static void send_line(const char *line) {
+	parse_line(&measured, line);
+}
+
+static void read_results(BenchResults *list, const char *path) {
+	char line[256];
+	FILE *file = fopen(path, "r");
+
+	if(!file) {
+		fprintf(stderr, "dino-bench: cannot open %s\n", path);
+		exit(1);
+	}
+	while(fgets(line, sizeof(line), file)) {
+		parse_line(list, line);
+	}
+	fclose(file);
+}
+
+static int same_case(const BenchResult *a, const BenchResult *b) {
+	return !strcmp(a->primitive, b->primitive) && !strcmp(a->subject, b->subject) && a->x == b->x && a->y == b->y;
+}
+
+/**
+ * @brief Finds a result of a case, or 0 if the list has none.
+ *
+ * @param variant The variant to find, or 0 for the same variant as the result.
+ */
+static const BenchResult *find_result(const BenchResults *list, const BenchResult *result, const char *variant) {
+	int i;
+
+	for(i = 0; i < list->count; i++) {
+		const BenchResult *other = &list->results[i];
+		if(same_case(other, result) && !strcmp(other->variant, variant ? variant : result->variant)) {
+			return other;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief The time of a result to compare with another: cycles when both have them, nanoseconds otherwise.
+ */
+static double cost(const BenchResult *result, const BenchResult *other) {
+	return result->cycles >= 0 && other->cycles >= 0 ? result->cycles : result->ns;
+}
+
+static void print_lines(const BenchResults *list) {
+	int i;
+
+	for(i = 0; i < list->count; i++) {
+		const BenchResult *result = &list->results[i];
+
+		printf("bench %s %s %s %d %d ", result->primitive, result->subject, result->variant, result->x, result->y);
+		if(result->cycles >= 0) {
+			printf("%.1f %.1f %s\n", result->cycles, result->ns, result->check);
+		} else {
+			printf("- %.1f %s\n", result->ns, result->check);
+		}
+	}
+}
+
+/**
+ * @brief Prints the results as a table, a blank line between cases.
+ */
+static void print_table(const BenchResults *list) {
+	int i;
+
+	printf("%-16s %-13s %4s %4s  %-16s %10s %10s %8s\n", "primitive", "subject", "x", "y", "variant", "cycles", "ns", "speedup");
+	for(i = 0; i < list->count; i++) {
+		const BenchResult *result = &list->results[i];
+		const BenchResult *reference = find_result(list, result, "reference");
+
+		if(i > 0 && !same_case(result, &list->results[i - 1])) {
+			printf("\n");
+		}
+		printf("%-16s %-13s %4d %4d  %-16s ", result->primitive, result->subject, result->x, result->y, result->variant);
+		if(result->cycles >= 0) {
+			printf("%10.1f ", result->cycles);
+		} else {
+			printf("%10s ", "-");
+		}
+		printf("%10.1f ", result->ns);
+		if(reference && reference != result && cost(result, reference) > 0) {
+			printf("%7.1fx", cost(reference, result) / cost(result, reference));
+		}
+		printf("%s\n", strcmp(result->check, "BAD") ? "" : "  BAD");
+	}
+}
+
+/**
+ * @brief Counts the variants that did not draw what the reference drew.
+ */
+static int count_bad(const BenchResults *list) {
+	int i, bad = 0;
+
+	for(i = 0; i < list->count; i++) {
+		bad += !strcmp(list->results[i].check, "BAD");
+	}
+	return bad;
+}
+
+/**
+ * @brief Reports the cases that got slower than the baseline by more than a threshold.
+ *
+ * @return The number of cases that did.
+ */
+static int compare_baseline(const BenchResults *list, const BenchResults *base, double percent) {
+	int i, regressions = 0, missing = 0;
+
+	for(i = 0; i < list->count; i++) {
+		const BenchResult *result = &list->results[i];
+		const BenchResult *old = find_result(base, result, 0);
+		double now, before;
+
+		if(!old) {
+			missing++;
+			continue;
+		}
+		now = cost(result, old);
+		before = cost(old, result);
+		if(now > before * (1 + percent / 100)) {
+			printf("slower: %s %s %s at %d,%d: %.1f, was %.1f (%+.0f%%)\n", result->primitive, result->subject,
+				result->variant, result->x, result->y, now, before, (now / before - 1) * 100);
+			regressions++;
+		}
+	}
+	printf("%d of %d cases more than %.0f%% slower than the baseline", regressions, list->count - missing, percent);
+	if(missing) {
+		printf(", %d not in it", missing);
+	}
+	printf("\n");
+	return regressions;
+}
+
+int main(int argc, char **argv) {
+	BenchClock clock = { read_ns, 0, 1000, 1, 1, 1000, send_line };
+	const char *results_path = 0;
+	const char *baseline_path = 0;
+	double percent = 10;
+	int lines = 0;
+	int option, bad;
+
+	while((option = getopt(argc, argv, "n:c:r:b:t:l")) != -1) {
+		switch(option) {
+		case 'n': clock.calls = atoi(optarg); break;
+		case 'c': clock.cycles_num = atoi(optarg); break;
+		case 'r': results_path = optarg; break;
+		case 'b': baseline_path = optarg; break;
+		case 't': percent = atof(optarg); break;
+		case 'l': lines = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-n calls] [-c MHz] [-r results] [-b baseline] [-t percent] [-l]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(clock.calls <= 0) {
+		fprintf(stderr, "dino-bench: calls must be positive\n");
+		return 1;
+	}
+
+	if(results_path) {
+		read_results(&measured, results_path);
+	} else {
+		bench_run(&clock);
+	}
+
+	if(lines) {
+		print_lines(&measured);
+	} else {
+		print_table(&measured);
+	}
+	bad = count_bad(&measured);
+	if(bad) {
+		printf("%d variants did not draw what the reference drew\n", bad);
+	}
+	if(baseline_path) {
+		read_results(&baseline, baseline_path);
+		bad += compare_baseline(&measured, &baseline, percent);
+	}
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,658 @@
+/**
+ * @file dino-frames.c
+ * @brief Host tool that checks that the renderer still draws every frame exactly as before.
+ *
+ * The tool links the real drawing code (display.c, game.c and the screens in menu.c,
+ * gameover.c, enter_name.c and highscore.c) and plays scripted sequences through it:
+ *
+ *     menu     every page of the menu, the game over screen and the enter name screen
+ *     game     runs played by the autopilot until it lets go, with and without a ghost,
+ *              one of them after 20000 ticks that are not drawn, at full speed
+ *     rewind   a run stepped backward through the rewind buffer, across a score of 10,
+ *              and forward again
+ *
+ * display_objects() sends only the dirty spans, so the tool keeps a copy of what the
+ * display would show and updates it from the dirty spans only. Every call to
+ * display_objects() is one frame, and the FNV-1a hash of that copy is compared with the
+ * hash on the same line of the golden list of the sequence, tools/golden/<sequence>.txt.
+ * Any change to the blitters, the clipping, the dirty tracking or the incremental redraw
+ * that changes a single pixel of a single frame shows up as a mismatch.
+ *
+ * For the first frames that differ the tool writes three PBM images to -o: what was drawn,
+ * what should have been drawn and the pixels that differ. The image that should have been
+ * drawn comes from a reference renderer in this file, which draws each screen from scratch
+ * one pixel at a time from the sprites, the font and the state of the game, without any of
+ * the drawing code it checks. With -R every frame of the reference renderer is checked
+ * against the golden lists too, which shows that the reference still draws what they hold.
+ *
+ * -w writes the golden lists instead of checking them. That is only for changes that are
+ * meant to change what is drawn, or the game or the autopilot; check the new frames first.
+ *
+ * Usage: dino-frames [-w] [-R] [-g golden directory] [-o image directory] [sequence...]
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../declare.h"
+
+#define MAX_FRAMES 8192
+#define MAX_DUMPS 4 // Frames whose images are written, per sequence
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// What the screen of the frame being drawn shows, for the reference renderer
+typedef enum {
+	SCREEN_GAME,
+	SCREEN_MENU,
+	SCREEN_GAME_OVER,
+	SCREEN_ENTER_NAME
+} ScreenKind;
+
+typedef struct {
+	const char *name;
+	void (*play)(void);
+} Sequence;
+
+// The state the drawing code reads, defined in main.c on the ChipKIT
+GameContext game;
+Replay replay;
+Replay best_replay;
+int has_best_replay;
+
+GameContext ghost;
+RewindBuffer rewind_buffer;
+
+// What the display shows, updated from the dirty spans only
+uint8_t screen[4][128];
+
+ScreenKind screen_kind;
+const GameContext *screen_ghost; // The ghost drawn with the game, or 0
+char frame_note[64];             // Where in the sequence the frame is, for the report
+
+// The sequence being played and its golden list
+const char *sequence_name;
+uint64_t golden[MAX_FRAMES];
+int golden_count;
+int frame_count;
+int mismatches;
+int reference_mismatches;
+int first_mismatch;
+
+int writing;
+int checking_reference;
+const char *golden_dir = "tools/golden";
+const char *image_dir = ".";
+
+// The reference renderer draws into one byte per pixel
+uint8_t reference[32][128];
+
+void change_state(GameState newState) {}
+
+static void reference_pixel(int x, int y) {
+	if(x >= 0 && x < 128 && y >= 0 && y < 32) {
+		reference[y][x] = 1;
+	}
+}
+
+static void reference_rectangle(int x, int y, int width, int height) {
+	int i, j;
+
+	for(j = y; j < y + height; j++) {
+		for(i = x; i < x + width; i++) {
+			reference_pixel(i, j);
+		}
+	}
+}
+
+/**
+ * @brief Draws the first columns and rows of a glyph of the font.
+ */
+static void reference_glyph(int x, int y, char c, int columns, int rows) {
+	const uint8_t *glyph = font[(c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR ? '?' : c) - FONT_FIRST_CHAR];
+	int i, j;
+
+	for(i = 0; i < columns; i++) {
+		for(j = 0; j < rows; j++) {
+			if(glyph[i] >> j & 1) {
+				reference_pixel(x + i, y + j);
+			}
+		}
+	}
+}
+
+static void reference_string(int x, int y, const char *s) {
+	for(; *s; s++, x += FONT_WIDTH + 1) {
+		reference_glyph(x, y, *s, FONT_WIDTH, 8);
+	}
+}
+
+static void reference_number(int x, int y, int n) {
+	char digits[16];
+	int i;
+
+	snprintf(digits, sizeof(digits), "%d", n);
+	for(i = 0; digits[i]; i++) {
+		reference_glyph(x + i * 5, y, digits[i], DIGIT_WIDTH, 8);
+	}
+}
+
+/**
+ * @brief Draws a sprite, or with dithered set only its pixels on the screen's checkerboard.
+ *
+ * Run-length encoded sprites are decoded into packed columns first.
+ */
+static void reference_sprite(int x, int y, const Sprite *sprite, int dithered) {
+	uint8_t packed[4 * 128] = { 0 };
+	const uint8_t *data = sprite->data;
+	int width = sprite->width;
+	int i, j;
+
+	if(sprite->encoding == SPRITE_RLE) {
+		for(j = 0; j < sprite->height; j += 8) {
+			i = 0;
+			while(i < width) {
+				int count = data[1];
+
+				i += data[0];
+				memcpy(&packed[(j >> 3) * width + i], data + 2, count);
+				data += 2 + count;
+				i += count;
+			}
+		}
+		data = packed;
+	}
+
+	for(i = 0; i < width; i++) {
+		for(j = 0; j < sprite->height; j++) {
+			if((data[(j >> 3) * width + i] >> (j & 7) & 1) && (!dithered || ((x + i + y + j) & 1) == 0)) {
+				reference_pixel(x + i, y + j);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Draws a game screen: the background, the score, the obstacle, the dino and the ghost.
+ *
+ * The score digits replace the 5 rows they cover, like draw_bcd() does in the background.
+ */
+static void reference_game(const GameContext *game, const GameContext *ghost) {
+	int digits = 1;
+	int i, j;
+
+	reference_rectangle(0, 31, 128, 1);
+	reference_string(0, 0, "score: ");
+	reference_string(50, 0, "highscore: ");
+	reference_number(110, 0, highscore);
+
+	while(digits < 8 && game->score_bcd >> (4 * digits)) {
+		digits++;
+	}
+	for(i = 0; i < digits; i++) {
+		int x = 35 + i * (DIGIT_WIDTH + 1);
+
+		for(j = 0; j < FONT_HEIGHT; j++) {
+			memset(&reference[j][x], 0, DIGIT_WIDTH);
+		}
+		reference_glyph(x, 0, '0' + (game->score_bcd >> (4 * (digits - 1 - i)) & 0xF), DIGIT_WIDTH, FONT_HEIGHT);
+	}
+
+	reference_sprite(game->obstacle_x, game->obstacle_y, game->obstacle, 0);
+	reference_sprite(game->character_x, game->character_y, game->character, 0);
+	if(ghost && !ghost->game_over) {
+		reference_sprite(ghost->character_x, ghost->character_y, ghost->character, 1);
+	}
+}
+
+static void reference_leaderboard(void) {
+	int i;
+
+	reference_string(30, 0, "leaderboard");
+	for(i = 0; i < NUM_LEADERBOARD_ENTRIES; i++) {
+		char name[INITIALS_LENGTH + 1] = { 0 };
+
+		memcpy(name, leaderboard_initials[i], INITIALS_LENGTH);
+		reference_number(5 + i * 20, 8, i + 1);
+		reference_number(i * 20, 15, leaderboard_scores[i]);
+		reference_string(i * 20, 22, name);
+	}
+}
+
+/**
+ * @brief Draws a page of the menu the way draw_menu() lays it out.
+ */
+static void reference_menu(int page) {
+	static const char *const lines[5][4] = {
+		{ 0 },
+		{ "menu controls", "start: btn4", "next: btn2", "replay: btn3" },
+		{ "controls", "jump: btn4", "duck: btn3", "ghost: sw1 on" },
+		{ 0 },
+		{ "credits", "mattias kvist", "elias hollstrand", 0 },
+	};
+	static const int title_x[5] = { 0, 25, 40, 0, 40 };
+	int i;
+
+	if(page == 0) {
+		reference_sprite(0, 0, &title, 0);
+		return;
+	}
+	if(page == 3) {
+		reference_leaderboard();
+		return;
+	}
+
+	reference_rectangle(0, 0, 127, 1);
+	reference_rectangle(0, 31, 127, 1);
+	reference_string(title_x[page], 3, lines[page][0]);
+	for(i = 1; i < 4 && lines[page][i]; i++) {
+		reference_string(0, 3 + 7 * i, lines[page][i]);
+	}
+	if(page == 2) {
+		reference_string(66, 10, "rewind:2+3");
+	}
+}
+
+/**
+ * @brief Draws the screen of the frame being drawn from scratch.
+ */
+static void draw_reference(void) {
+	memset(reference, 0, sizeof(reference));
+
+	switch(screen_kind) {
+	case SCREEN_GAME:
+		reference_game(&game, screen_ghost);
+		break;
+
+	case SCREEN_MENU:
+		reference_menu(menu_page % 5);
+		break;
+
+	case SCREEN_GAME_OVER: {
+		char seed[9];
+
+		snprintf(seed, sizeof(seed), "%08x", (unsigned)game.seed);
+		reference_string(0, 0, "game over");
+		reference_string(80, 0, seed);
+		reference_string(0, 8, "your score: ");
+		reference_number(65, 8, game.score);
+		reference_string(0, 16, "highscore: ");
+		reference_number(60, 16, highscore);
+		reference_string(80, 16, "btn3:rew");
+		reference_string(0, 24, "btn4:start btn2:menu");
+		break;
+	}
+
+	case SCREEN_ENTER_NAME:
+		reference_string(0, 0, "congratulations");
+		reference_string(0, 8, "you got a highscore");
+		reference_string(0, 16, "enter name:");
+		reference_string(75, 16, initials);
+		reference_sprite(75 + letter_index * 6, 24, &arrow_up, 0);
+		reference_string(0, 24, "btn3:save");
+		break;
+	}
+}
+
+static int screen_pixel(const uint8_t frame[4][128], int x, int y) {
+	return frame[y >> 3][x] >> (y & 7) & 1;
+}
+
+static uint64_t hash_frame(const uint8_t frame[4][128]) {
+	uint64_t hash = FNV_OFFSET;
+	int page, x;
+
+	for(page = 0; page < 4; page++) {
+		for(x = 0; x < 128; x++) {
+			hash = (hash ^ frame[page][x]) * FNV_PRIME;
+		}
+	}
+	return hash;
+}
+
+/**
+ * @brief Packs the reference screen into pages, the way pixel_data holds a frame.
+ */
+static void pack_reference(uint8_t frame[4][128]) {
+	int x, y;
+
+	memset(frame, 0, 4 * 128);
+	for(y = 0; y < 32; y++) {
+		for(x = 0; x < 128; x++) {
+			frame[y >> 3][x] |= reference[y][x] << (y & 7);
+		}
+	}
+}
+
+/**
+ * @brief Writes a frame as a plain PBM image, 1 being a lit pixel.
+ *
+ * @param kind "actual", "expected" or "diff", the last letting a pixel be lit where the other two differ.
+ */
+static void write_image(const char *kind, const uint8_t actual[4][128], const uint8_t expected[4][128]) {
+	char path[512];
+	FILE *file;
+	int x, y;
+
+	snprintf(path, sizeof(path), "%s/%s-%04d-%s.pbm", image_dir, sequence_name, frame_count, kind);
+	file = fopen(path, "w");
+	if(!file) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(file, "P1\n# %s frame %d (%s), %s\n128 32\n", sequence_name, frame_count, frame_note, kind);
+	for(y = 0; y < 32; y++) {
+		for(x = 0; x < 128; x++) {
+			int pixel = kind[0] == 'd' ? screen_pixel(actual, x, y) ^ screen_pixel(expected, x, y)
+				: screen_pixel(kind[0] == 'a' ? actual : expected, x, y);
+			fputc('0' + pixel, file);
+			if(x % 64 == 63) {
+				fputc('\n', file);
+			}
+		}
+	}
+	fclose(file);
+}
+
+/**
+ * @brief Sends the frame to the copy of the display and checks it against the golden list.
+ *
+ * Only the dirty spans are copied and then reset, like the real display_objects() does
+ * after sending them.
+ */
+void display_objects(void) {
+	uint8_t expected[4][128];
+	uint64_t hash;
+	int page, x;
+
+	for(page = 0; page < 4; page++) {
+		for(x = dirty_start[page]; x < dirty_end[page]; x++) {
+			screen[page][x] = pixel_data[page][x];
+		}
+		dirty_start[page] = 128;
+		dirty_end[page] = 0;
+	}
+
+	if(frame_count >= MAX_FRAMES) {
+		fprintf(stderr, "dino-frames: %s has more than %d frames\n", sequence_name, MAX_FRAMES);
+		exit(1);
+	}
+	hash = hash_frame(screen);
+
+	if(writing) {
+		golden[frame_count++] = hash;
+		return;
+	}
+
+	if(checking_reference) {
+		draw_reference();
+		pack_reference(expected);
+		if(frame_count >= golden_count || hash_frame(expected) != golden[frame_count]) {
+			if(reference_mismatches++ == 0) {
+				printf("%s: the reference differs from frame %d (%s)\n", sequence_name, frame_count, frame_note);
+			}
+		}
+	}
+
+	if(frame_count >= golden_count || hash != golden[frame_count]) {
+		if(mismatches++ == 0) {
+			first_mismatch = frame_count;
+		}
+		if(mismatches <= MAX_DUMPS) {
+			draw_reference();
+			pack_reference(expected);
+			printf("%s: frame %d (%s) differs, written to %s/%s-%04d-*.pbm\n",
+				sequence_name, frame_count, frame_note, image_dir, sequence_name, frame_count);
+			write_image("actual", screen, expected);
+			write_image("expected", screen, expected);
+			write_image("diff", screen, expected);
+		}
+	}
+	frame_count++;
+}
+
+/**
+ * @brief Plays a run with the autopilot until it lets go and the dino hits an obstacle.
+ *
+ * @param seed The seed of the run.
+ * @param skip Ticks to play before anything is drawn.
+ * @param frames Most ticks to draw.
+ * @param let_go The score at which the autopilot stops pressing buttons.
+ * @param with_ghost 1 to play a ghost alongside: the same seed played 15 ticks behind,
+ *                   letting go 5 points earlier.
+ */
+static void play_run(uint32_t seed, int skip, int frames, int let_go, int with_ghost) {
+	Autopilot pilot, ghost_pilot;
+	int tick;
+
+	reset_game(&game, &game_rules, seed);
+	reset_game(&ghost, &game_rules, seed);
+	autopilot_reset(&pilot, &game, 0);
+	autopilot_reset(&ghost_pilot, &ghost, 0);
+	screen_kind = SCREEN_GAME;
+	screen_ghost = with_ghost ? &ghost : 0;
+
+	for(tick = 0; tick < skip + frames && !game.game_over; tick++) {
+		update_game(&game, game.score < let_go ? autopilot_buttons(&pilot, &game) : 0);
+		if(with_ghost && tick >= 15) {
+			update_game(&ghost, ghost.score < let_go - 5 ? autopilot_buttons(&ghost_pilot, &ghost) : 0);
+		}
+		if(tick == skip) {
+			reset_display(&game);
+		}
+		if(tick >= skip) {
+			snprintf(frame_note, sizeof(frame_note), "seed %u, tick %d", (unsigned)seed, tick);
+			update_display(&game, screen_ghost);
+		}
+	}
+}
+
+static void play_menu(void) {
+	static const uint8_t scores[NUM_LEADERBOARD_ENTRIES] = { 212, 97, 64, 40, 9, 0 };
+	static const char names[] = "elimataxeflumvpdjs";
+	Autopilot pilot;
+	int page;
+
+	memcpy(leaderboard_scores, scores, sizeof(scores));
+	memcpy(leaderboard_initials, names, sizeof(leaderboard_initials));
+	highscore = scores[0];
+
+	screen_kind = SCREEN_MENU;
+	for(page = 0; page < 5; page++) {
+		menu_page = page;
+		snprintf(frame_note, sizeof(frame_note), "menu page %d", page);
+		draw_menu();
+	}
+	menu_page = 0;
+
+	// The game over screen of a run the autopilot let go of at 17
+	reset_game(&game, &game_rules, 0x1234abcd);
+	autopilot_reset(&pilot, &game, 0);
+	while(!game.game_over) {
+		update_game(&game, game.score < 17 ? autopilot_buttons(&pilot, &game) : 0);
+	}
+	screen_kind = SCREEN_GAME_OVER;
+	snprintf(frame_note, sizeof(frame_note), "game over");
+	draw_gameover();
+
+	screen_kind = SCREEN_ENTER_NAME;
+	strcpy(initials, "eli");
+	for(letter_index = 0; letter_index < INITIALS_LENGTH; letter_index++) {
+		snprintf(frame_note, sizeof(frame_note), "enter name, letter %d", letter_index);
+		draw_enter_name();
+	}
+	letter_index = 0;
+}
+
+static void play_game(void) {
+	highscore = 97;
+	play_run(1, 0, 3000, 15, 0);
+	play_run(2, 0, 3000, 25, 1);
+	play_run(3, 0, 3000, 12, 1);
+	play_run(4, 20000, 600, 100000, 1);
+}
+
+static void play_rewind(void) {
+	Autopilot pilot;
+	uint32_t tick;
+
+	highscore = 40;
+	reset_game(&game, &game_rules, 5);
+	autopilot_reset(&pilot, &game, 0);
+	rewind_start(&rewind_buffer, &game);
+	screen_kind = SCREEN_GAME;
+	screen_ghost = 0;
+	reset_display(&game);
+
+	// Seed 5 scores its 10th point at tick 712, so stepping back goes from 2 digits to 1
+	for(tick = 1; tick <= 800; tick++) {
+		int buttons = autopilot_buttons(&pilot, &game);
+
+		update_game(&game, buttons);
+		rewind_record(&rewind_buffer, &game, buttons);
+		snprintf(frame_note, sizeof(frame_note), "tick %u", (unsigned)tick);
+		update_display(&game, 0);
+	}
+	for(tick = rewind_buffer.end; tick > rewind_buffer.first; ) {
+		rewind_load(&rewind_buffer, --tick, &game);
+		snprintf(frame_note, sizeof(frame_note), "back to tick %u", (unsigned)tick);
+		update_display(&game, 0);
+	}
+	while(tick < rewind_buffer.first + 120) {
+		rewind_step(&rewind_buffer, &game, ++tick);
+		snprintf(frame_note, sizeof(frame_note), "forward to tick %u", (unsigned)tick);
+		update_display(&game, 0);
+	}
+}
+
+const Sequence sequences[] = {
+	{ "menu", play_menu },
+	{ "game", play_game },
+	{ "rewind", play_rewind },
+};
+
+#define NUM_SEQUENCES (int)(sizeof(sequences) / sizeof(sequences[0]))
+
+static void golden_path(char *path, int size, const char *name) {
+	snprintf(path, size, "%s/%s.txt", golden_dir, name);
+}
+
+/**
+ * @brief Reads the golden list of a sequence: one hash per frame, in hex, and # comments.
+ */
+static void read_golden(const char *name) {
+	char path[512], line[128];
+	FILE *file;
+
+	golden_path(path, sizeof(path), name);
+	file = fopen(path, "r");
+	if(!file) {
+		perror(path);
+		exit(1);
+	}
+	golden_count = 0;
+	while(fgets(line, sizeof(line), file)) {
+		if(line[0] == '#' || line[0] == '\n') {
+			continue;
+		}
+		if(golden_count == MAX_FRAMES) {
+			fprintf(stderr, "%s: more than %d frames\n", path, MAX_FRAMES);
+			exit(1);
+		}
+		golden[golden_count++] = strtoull(line, 0, 16);
+	}
+	fclose(file);
+}
+
+static void write_golden(const char *name) {
+	char path[512];
+	FILE *file;
+	int i;
+
+	golden_path(path, sizeof(path), name);
+	file = fopen(path, "w");
+	if(!file) {
+		perror(path);
+		exit(1);
+	}
+	fprintf(file, "# Frame hashes of the %s sequence of tools/dino-frames, one per frame\n", name);
+	for(i = 0; i < frame_count; i++) {
+		fprintf(file, "%016llx\n", (unsigned long long)golden[i]);
+	}
+	fclose(file);
+}
+
+/**
+ * @brief Plays a sequence and checks (or writes) its golden list.
+ *
+ * @return 1 if every frame matched.
+ */
+static int run_sequence(const Sequence *sequence) {
+	sequence_name = sequence->name;
+	frame_count = 0;
+	mismatches = 0;
+	reference_mismatches = 0;
+	if(!writing) {
+		read_golden(sequence->name);
+	}
+
+	memset(screen, 0, sizeof(screen));
+	clear_all_pixels();
+	sequence->play();
+
+	if(writing) {
+		write_golden(sequence->name);
+		printf("%s: %d frames written\n", sequence->name, frame_count);
+		return 1;
+	}
+	if(frame_count != golden_count) {
+		printf("%s: %d frames drawn, the golden list has %d\n", sequence->name, frame_count, golden_count);
+		mismatches += frame_count < golden_count;
+	}
+	if(checking_reference) {
+		printf("%s: the reference matches %d of %d frames\n", sequence->name, frame_count - reference_mismatches, frame_count);
+	}
+	if(mismatches) {
+		printf("%s: %d of %d frames differ, the first is frame %d\n", sequence->name, mismatches, frame_count, first_mismatch);
+		return 0;
+	}
+	printf("%s: %d frames match\n", sequence->name, frame_count);
+	return 1;
+}
+
+int main(int argc, char **argv) {
+	int option, i, ok = 1;
+
+	while((option = getopt(argc, argv, "wRg:o:")) != -1) {
+		switch(option) {
+		case 'w': writing = 1; break;
+		case 'R': checking_reference = 1; break;
+		case 'g': golden_dir = optarg; break;
+		case 'o': image_dir = optarg; break;
+		default:
+			fprintf(stderr, "usage: %s [-w] [-R] [-g golden directory] [-o image directory] [sequence...]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	build_game_rules(&game_rules);
+
+	for(i = 0; i < NUM_SEQUENCES; i++) {
+		int j, wanted = optind == argc;
+
+		for(j = optind; j < argc; j++) {
+			wanted |= strcmp(argv[j], sequences[i].name) == 0;
+		}
+		if(wanted) {
+			ok &= run_sequence(&sequences[i]);
+		}
+	}
+	return ok ? 0 : 1;
+}
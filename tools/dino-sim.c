@@ -0,0 +1,826 @@
+/**
+ * @file dino-sim.c
+ * @brief Host tool that runs the game logic headless, as fast as the machine allows.
+ *
+ * The simulator links the real game.c, random.c, data.c and display.c, so it plays
+ * exactly the game the ChipKIT plays, tick for tick. The buttons come from a script
+ * file instead of the Basic I/O Shield. A script is a list of runs of ticks:
+ *
+ *     # comment until the end of the line
+ *     seed 0x1234abcd     (optional, the seed of the first game)
+ *     40-                 40 ticks with no button held
+ *     12j                 12 ticks with jump (BTN4) held
+ *     20d                 20 ticks with duck (BTN3) held
+ *
+ * Runs can be separated by any white space, so "40- 12j 20d" on one line is the same
+ * script. When the script ends the buttons are released, or with -l the script starts
+ * over. Without a script no button is ever pressed.
+ *
+ * A replay, as the ChipKIT sends it over the UART at the end of every run, is also a
+ * script: the word "replay" followed by the hex digits of the replay (see replay.c).
+ * It sets the seed and the buttons of every tick, and after playing it the simulator
+ * checks that the first game ended with the score and on the tick it was recorded with.
+ * With -R the first game is recorded into a replay file of the same format.
+ *
+ * Every game runs until the dino hits an obstacle or -t ticks have passed. With -n the
+ * simulator plays several games in a row, game i using the seed of the first game plus i
+ * and the script from the start. Nothing is drawn unless -r is given, in which case every
+ * tick is also drawn into the frame buffer by update_display(), and display_objects()
+ * throws the frame away instead of sending it.
+ *
+ * When done, the simulator prints the number of ticks, the ticks per second, the final
+ * and the best score, and a hash of the state of every game after every tick. The same
+ * seeds and script always give the same hash, so any change to the game logic that
+ * changes how a game plays out shows up as a different hash.
+ *
+ * With -G every game is played next to a ghost, the game in a replay file stepped in the
+ * same tick, and with -r the ghost is drawn too, the way the ChipKIT races the top score.
+ * Comparing the ticks per second with and without -G shows what the ghost costs. The
+ * ghost has the seed of its replay; start the games with the same seed (-s) to have the
+ * ghost meet the same obstacles.
+ *
+ * With -W every game is recorded in a rewind buffer (see rewind.c) as it is played, and
+ * the buffer of the last game is printed at the end, one line per tick, the way the debug
+ * build sends it over the UART. Every state rebuilt from the buffer has to match the
+ * check recorded when it was played.
+ *
+ * With -A the games are played by the autopilot (see autopilot.c) instead of the script,
+ * as in the attract mode and the soak test on the ChipKIT. Comparing the ticks per second
+ * with those of a script shows what its decisions cost.
+ *
+ * With -B the games are played N at a time by the batched engine (see batch.c), which
+ * keeps them in structure-of-arrays form and advances them all with vector code. Each
+ * game gets its seed and script as without -B and the hash is the same, as the batch
+ * plays exactly what update_game() plays. With -V every tick of every game is played
+ * both ways side by side and compared field by field, and the time each way takes per
+ * tick of one game is printed; -V stops at the first game that differs.
+ *
+ * Usage: dino-sim [-s seed] [-n games] [-t ticks] [-l] [-r] [-R replay] [-G replay] [-W] [-A] [-B N] [-V] [script]
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "batch.h"
+
+#define MAX_SCRIPT_RUNS 65536
+#define DEFAULT_LANES 1024 // Games played at a time by -V without -B
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+typedef struct {
+	uint32_t ticks;
+	uint8_t buttons;
+} InputRun;
+
+// Where a game is in the script
+typedef struct {
+	int run;
+	uint32_t left; // Ticks left of the run
+} ScriptCursor;
+
+// What a game played to
+typedef struct {
+	uint64_t ticks;
+	int score;
+	uint64_t hash;
+} GameResult;
+
+// The game shown on the display on the ChipKIT, here the one drawn with -r
+GameContext game;
+int highscore;
+
+InputRun script[MAX_SCRIPT_RUNS];
+int script_length;
+int loop;
+
+uint32_t first_seed = 1;
+long games = 1;
+uint64_t max_ticks = 100000000;
+
+Replay loaded_replay; // The replay the script was read from
+int have_replay;
+Replay ghost_replay;  // The replay played as the ghost with -G
+int have_ghost;
+RewindBuffer rewind_buffer; // The last seconds of the game being played, with -W
+int rewinding;
+int piloting;               // The autopilot plays instead of the script, with -A
+int lanes;                  // Games played at a time by the batched engine, with -B
+
+/**
+ * @brief Throws away the frame drawn by update_display() (the null renderer).
+ *
+ * Only the dirty spans are reset, like the real display_objects() does after sending them.
+ */
+void display_objects(void) {
+	int page;
+	for(page = 0; page < 4; page++) {
+		dirty_start[page] = 128;
+		dirty_end[page] = 0;
+	}
+}
+
+static void fail(const char *path, int line, const char *message) {
+	fprintf(stderr, "%s:%d: %s\n", path, line, message);
+	exit(1);
+}
+
+/**
+ * @brief Adds ticks with the given buttons to the end of the script.
+ */
+static void add_run(const char *path, int line, uint32_t ticks, uint8_t buttons) {
+	// Consecutive runs of the same buttons are merged
+	if(script_length > 0 && script[script_length - 1].buttons == buttons) {
+		script[script_length - 1].ticks += ticks;
+	} else if(script_length == MAX_SCRIPT_RUNS) {
+		fail(path, line, "script too long");
+	} else {
+		script[script_length].ticks = ticks;
+		script[script_length].buttons = buttons;
+		script_length++;
+	}
+}
+
+/**
+ * @brief Reads the hex digits of a replay, up to the end of the file.
+ */
+static void parse_replay(FILE *file, const char *path, int line, Replay *replay) {
+	uint8_t bytes[REPLAY_HEADER_BYTES + REPLAY_BYTES] = {0};
+	int size = 0;
+	int digits = 0;
+	int c;
+
+	while((c = fgetc(file)) != EOF) {
+		if(isspace(c)) {
+			continue;
+		}
+		if(!isxdigit(c)) {
+			fail(path, line, "expected hex digits after replay");
+		}
+		if(size == (int)sizeof(bytes)) {
+			fail(path, line, "replay too long");
+		}
+		bytes[size] = bytes[size] << 4 | (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+		if(++digits % 2 == 0) {
+			size++;
+		}
+	}
+	if(digits % 2 || size < REPLAY_HEADER_BYTES || !replay_decode_header(replay, bytes) ||
+			size != REPLAY_HEADER_BYTES + replay->length) {
+		fail(path, line, "not a valid replay");
+	}
+	memcpy(replay->runs, bytes + REPLAY_HEADER_BYTES, replay->length);
+}
+
+/**
+ * @brief Reads a replay into the script.
+ *
+ * The seed comes from the replay, and the replay is kept in loaded_replay so the game
+ * can be checked against the score it was recorded with.
+ */
+static void load_replay(FILE *file, const char *path, int line, uint32_t *seed) {
+	ReplayCursor cursor;
+
+	parse_replay(file, path, line, &loaded_replay);
+	have_replay = 1;
+	*seed = loaded_replay.seed;
+
+	uint32_t ticks = replay_ticks(&loaded_replay);
+	replay_rewind(&cursor, &loaded_replay);
+	while(ticks-- > 0) {
+		add_run(path, line, 1, replay_next(&cursor));
+	}
+}
+
+/**
+ * @brief Reads a file holding only a replay, for -G.
+ */
+static void load_ghost(const char *path, Replay *replay) {
+	FILE *file = fopen(path, "r");
+	char word[8];
+
+	if(!file) {
+		fprintf(stderr, "dino-sim: cannot open %s\n", path);
+		exit(1);
+	}
+	if(fscanf(file, "%7s", word) != 1 || strcmp(word, "replay")) {
+		fail(path, 1, "expected a replay");
+	}
+	parse_replay(file, path, 1, replay);
+	fclose(file);
+}
+
+/**
+ * @brief Reads a script into script[], and the seed from its seed line if it has one.
+ */
+static void load_script(const char *path, uint32_t *seed) {
+	FILE *file = fopen(path, "r");
+	char word[64];
+	int line = 1;
+	int c;
+
+	if(!file) {
+		fprintf(stderr, "dino-sim: cannot open %s\n", path);
+		exit(1);
+	}
+
+	for(;;) {
+		int length = 0;
+
+		while((c = fgetc(file)) != EOF && (isspace(c) || c == '#')) {
+			if(c == '#') {
+				while((c = fgetc(file)) != EOF && c != '\n');
+			}
+			if(c == '\n') {
+				line++;
+			}
+		}
+		if(c == EOF) {
+			break;
+		}
+		while(c != EOF && !isspace(c) && c != '#' && length < (int)sizeof(word) - 1) {
+			word[length++] = c;
+			c = fgetc(file);
+		}
+		word[length] = 0;
+		if(c != EOF) {
+			ungetc(c, file);
+		}
+
+		if(!strcmp(word, "replay")) {
+			load_replay(file, path, line, seed);
+			break;
+		}
+		if(!strcmp(word, "seed")) {
+			if(fscanf(file, "%63s", word) != 1) {
+				fail(path, line, "seed without a value");
+			}
+			*seed = strtoul(word, 0, 0);
+			continue;
+		}
+
+		char *key;
+		unsigned long ticks = strtoul(word, &key, 10);
+		uint8_t buttons;
+
+		if(key == word || key[1]) {
+			fail(path, line, "expected <ticks><key>, key being -, j or d");
+		}
+		switch(*key) {
+		case '-': buttons = 0; break;
+		case 'j': buttons = BTN4; break;
+		case 'd': buttons = BTN3; break;
+		default: fail(path, line, "unknown key, expected -, j or d");
+		}
+		if(ticks > 0) {
+			add_run(path, line, ticks, buttons);
+		}
+	}
+
+	fclose(file);
+}
+
+/**
+ * @brief Adds the state of a game to a running FNV-1a hash, one 32-bit field at a time.
+ *
+ * Sprites are hashed by their frame and size rather than their address, so the hash
+ * is the same for every build of the simulator.
+ */
+static uint64_t hash_fields(uint64_t hash, const int32_t *fields, int count) {
+	int i;
+
+	for(i = 0; i < count; i++) {
+		hash = (hash ^ (uint32_t)fields[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t hash_game(uint64_t hash, const GameContext *game) {
+	int32_t fields[] = {
+		game->character_y_q8, game->y_velocity, game->action, game->character_frame,
+		game->obstacle_x_q8, game->obstacle_y, game->obstacle_speed, game->obstacle_frame,
+		game->obstacle->width, game->obstacle->height, game->score, game->game_over,
+	};
+	return hash_fields(hash, fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+static void start_script(ScriptCursor *cursor) {
+	cursor->run = 0;
+	cursor->left = script_length ? script[0].ticks : 0;
+}
+
+/**
+ * @brief Returns the buttons of the next tick of the script and moves on.
+ */
+static int next_buttons(ScriptCursor *cursor) {
+	int buttons;
+
+	if(cursor->run >= script_length) {
+		return 0;
+	}
+	buttons = script[cursor->run].buttons;
+	if(--cursor->left == 0 && ++cursor->run == script_length && loop) {
+		cursor->run = 0;
+	}
+	if(cursor->left == 0 && cursor->run < script_length) {
+		cursor->left = script[cursor->run].ticks;
+	}
+	return buttons;
+}
+
+/**
+ * @brief Plays the games one after the other with update_game().
+ */
+static void play_games(GameResult *results, int render) {
+	long i;
+
+	for(i = 0; i < games; i++) {
+		ScriptCursor cursor;
+		Autopilot pilot;
+		GameContext ghost;
+		ReplayCursor ghost_cursor;
+		uint64_t hash = FNV_OFFSET;
+		uint64_t tick;
+
+		reset_game(&game, &game_rules, first_seed + i);
+		start_script(&cursor);
+		autopilot_reset(&pilot, &game, 0);
+		if(have_ghost) {
+			reset_game(&ghost, &game_rules, ghost_replay.seed);
+			replay_rewind(&ghost_cursor, &ghost_replay);
+		}
+		if(render) {
+			reset_display(&game);
+		}
+		if(rewinding) {
+			rewind_start(&rewind_buffer, &game);
+		}
+
+		for(tick = 0; tick < max_ticks && !game.game_over; tick++) {
+			int buttons = piloting ? autopilot_buttons(&pilot, &game) : next_buttons(&cursor);
+
+			update_game(&game, buttons);
+			if(rewinding) {
+				rewind_record(&rewind_buffer, &game, buttons);
+			}
+			if(have_ghost) {
+				update_game(&ghost, replay_next(&ghost_cursor));
+			}
+			if(render) {
+				update_display(&game, have_ghost ? &ghost : 0);
+			}
+			hash = hash_game(hash, &game);
+		}
+
+		results[i].ticks = tick;
+		results[i].score = game.score;
+		results[i].hash = hash;
+	}
+}
+
+static double seconds(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// A slot of the batch and the game it is playing
+typedef struct {
+	long game; // -1 once there are no games left to play
+	uint64_t ticks;
+	uint64_t hash;
+	ScriptCursor cursor;
+	Autopilot pilot;
+} Lane;
+
+/**
+ * @brief Adds the state of a game in a batch to a running hash, the same as hash_game() does.
+ */
+static uint64_t hash_lane(uint64_t hash, const GameBatch *batch, int i) {
+	if(batch->game_over[i]) {
+		return hash_game(hash, &batch->games[i]);
+	}
+
+	int32_t fields[] = {
+		batch->character_y_q8[i], batch->y_velocity[i], batch->action[i], batch->character_frame[i],
+		batch->obstacle_x[i] * 256 + batch->obstacle_x_fraction[i], batch->obstacle_y[i],
+		batch->obstacle_speed[i], batch->obstacle_frame[i],
+		batch->obstacle_width[i], batch->obstacle_height[i], batch->score[i], batch->game_over[i],
+	};
+	return hash_fields(hash, fields, sizeof(fields) / sizeof(fields[0]));
+}
+
+/**
+ * @brief Starts the next game in a slot of the batch, or empties the slot when all were started.
+ *
+ * @return 1 if a game was started.
+ */
+static int start_lane(GameBatch *batch, Lane *lane, int index, long *next) {
+	if(*next >= games) {
+		lane->game = -1;
+		batch->game_over[index] = 1; // An empty slot is left alone by batch_step()
+		return 0;
+	}
+	lane->game = (*next)++;
+	lane->ticks = 0;
+	lane->hash = FNV_OFFSET;
+	batch_reset(batch, index, first_seed + lane->game);
+	start_script(&lane->cursor);
+	autopilot_reset(&lane->pilot, &batch->games[index], 0);
+	return 1;
+}
+
+/**
+ * @brief Returns the buttons of the next tick of the game in a slot of the batch.
+ */
+static int lane_buttons(const GameBatch *batch, Lane *lane, int index) {
+	if(piloting) {
+		GameContext state;
+		batch_load(batch, index, &state);
+		return autopilot_buttons(&lane->pilot, &state);
+	}
+	return next_buttons(&lane->cursor);
+}
+
+static GameBatch *create_batch(void) {
+	GameBatch *batch = batch_create(lanes, &game_rules);
+
+	if(!batch) {
+		fprintf(stderr, "dino-sim: cannot create a batch of %d games\n", lanes);
+		exit(1);
+	}
+	return batch;
+}
+
+/**
+ * @brief Plays the games with batch_step(), starting the next game in a slot as soon as
+ * the one in it ends.
+ */
+static void play_batched(GameResult *results) {
+	GameBatch *batch = create_batch();
+	Lane *slots = calloc(lanes, sizeof(Lane));
+	long next = 0;
+	int busy = 0;
+	int i;
+
+	if(!slots) {
+		fprintf(stderr, "dino-sim: out of memory\n");
+		exit(1);
+	}
+
+	for(i = 0; i < lanes; i++) {
+		busy += start_lane(batch, &slots[i], i, &next);
+	}
+
+	while(busy > 0) {
+		for(i = 0; i < lanes; i++) {
+			if(slots[i].game >= 0) {
+				batch->buttons[i] = lane_buttons(batch, &slots[i], i);
+			}
+		}
+		batch_step(batch);
+
+		// Count the tick and refill the slots whose game has ended
+		for(i = 0; i < lanes; i++) {
+			Lane *lane = &slots[i];
+
+			if(lane->game < 0) {
+				continue;
+			}
+			lane->ticks++;
+			lane->hash = hash_lane(lane->hash, batch, i);
+			if(!batch->game_over[i] && lane->ticks < max_ticks) {
+				continue;
+			}
+
+			results[lane->game].ticks = lane->ticks;
+			results[lane->game].hash = lane->hash;
+			results[lane->game].score = batch->score[i];
+			busy -= !start_lane(batch, lane, i, &next);
+		}
+	}
+
+	batch_free(batch);
+	free(slots);
+}
+
+/**
+ * @brief Checks that two games are in the same state, printing the first field that differs.
+ */
+static int same_game(const GameContext *a, const GameContext *b, long index, uint64_t tick) {
+#define COMPARE(field) \
+	if(a->field != b->field) { \
+		fprintf(stderr, "dino-sim: game %ld differs at tick %llu: " #field "\n", index, (unsigned long long)tick); \
+		return 0; \
+	}
+	COMPARE(rules) COMPARE(character_y_q8) COMPARE(character_y) COMPARE(character_x) COMPARE(character_height)
+	COMPARE(y_velocity) COMPARE(action) COMPARE(character) COMPARE(character_animation)
+	COMPARE(character_frame) COMPARE(dino_frames_passed) COMPARE(obstacle_x_q8) COMPARE(obstacle_x)
+	COMPARE(obstacle_y) COMPARE(obstacle_speed) COMPARE(obstacle) COMPARE(obstacle_type)
+	COMPARE(obstacle_frame) COMPARE(obstacle_ticks) COMPARE(previous_obstacle_x)
+	COMPARE(previous_character_y) COMPARE(previous_character_height) COMPARE(score) COMPARE(score_bcd)
+	COMPARE(difficulty) COMPARE(recovery_ticks) COMPARE(spawn_pending) COMPARE(game_over) COMPARE(seed)
+	COMPARE(spawn_rng.state) COMPARE(spawn_rng.increment)
+#undef COMPARE
+	return 1;
+}
+
+/**
+ * @brief Plays the games with update_game() and with batch_step() side by side, from the same buttons.
+ *
+ * Each tick, every game of the batch is stepped one at a time with update_game() and then
+ * all together with batch_step(), and only these two steps are timed. Picking the buttons,
+ * refilling the slots and, with compare, checking that every game is in the same state
+ * both ways after every tick are left out of the times.
+ *
+ * @return 1 if every game was in the same state after every tick, 0 otherwise.
+ */
+static int race_batched(int compare, double *scalar_seconds, double *batched_seconds, uint64_t *ticks) {
+	GameBatch *batch = create_batch();
+	GameContext *scalar = calloc(lanes, sizeof(GameContext));
+	Lane *slots = calloc(lanes, sizeof(Lane));
+	long next = 0;
+	int busy = 0;
+	int i;
+
+	if(!scalar || !slots) {
+		fprintf(stderr, "dino-sim: out of memory\n");
+		exit(1);
+	}
+
+	for(i = 0; i < lanes; i++) {
+		if(start_lane(batch, &slots[i], i, &next)) {
+			reset_game(&scalar[i], &game_rules, first_seed + slots[i].game);
+			busy++;
+		}
+	}
+
+	*scalar_seconds = *batched_seconds = 0;
+	*ticks = 0;
+	while(busy > 0) {
+		for(i = 0; i < lanes; i++) {
+			if(slots[i].game >= 0) {
+				batch->buttons[i] = lane_buttons(batch, &slots[i], i);
+			}
+		}
+
+		double start = seconds();
+		for(i = 0; i < lanes; i++) {
+			if(slots[i].game >= 0) {
+				update_game(&scalar[i], batch->buttons[i]);
+			}
+		}
+		double middle = seconds();
+		batch_step(batch);
+		double end = seconds();
+
+		*scalar_seconds += middle - start;
+		*batched_seconds += end - middle;
+
+		for(i = 0; i < lanes; i++) {
+			Lane *lane = &slots[i];
+
+			if(lane->game < 0) {
+				continue;
+			}
+			lane->ticks++;
+			(*ticks)++;
+			if(compare) {
+				GameContext batched;
+				batch_load(batch, i, &batched);
+				if(!same_game(&scalar[i], &batched, lane->game, lane->ticks)) {
+					return 0;
+				}
+			}
+			if(!batch->game_over[i] && lane->ticks < max_ticks) {
+				continue;
+			}
+			if(start_lane(batch, lane, i, &next)) {
+				reset_game(&scalar[i], &game_rules, first_seed + lane->game);
+			} else {
+				busy--;
+			}
+		}
+	}
+
+	batch_free(batch);
+	free(scalar);
+	free(slots);
+	return 1;
+}
+
+/**
+ * @brief Plays the first game again, recording it, and writes the replay to a file.
+ *
+ * The file holds one line in the format the ChipKIT sends over the UART, and can be
+ * played back as a script.
+ */
+static void record_replay(const char *path) {
+	FILE *file = fopen(path, "w");
+	ScriptCursor cursor;
+	Replay recording;
+	uint8_t header[REPLAY_HEADER_BYTES];
+	uint64_t tick;
+	int i;
+
+	if(!file) {
+		fprintf(stderr, "dino-sim: cannot write %s\n", path);
+		exit(1);
+	}
+
+	reset_game(&game, &game_rules, first_seed);
+	replay_start(&recording, first_seed);
+	start_script(&cursor);
+	for(tick = 0; tick < max_ticks && !game.game_over; tick++) {
+		int buttons = next_buttons(&cursor);
+		replay_record(&recording, buttons);
+		update_game(&game, buttons);
+	}
+	replay_finish(&recording, game.score);
+
+	replay_encode_header(&recording, header);
+	fprintf(file, "replay ");
+	for(i = 0; i < REPLAY_HEADER_BYTES; i++) {
+		fprintf(file, "%02x", header[i]);
+	}
+	for(i = 0; i < recording.length; i++) {
+		fprintf(file, "%02x", recording.runs[i]);
+	}
+	fprintf(file, "\n");
+	fclose(file);
+
+	if(recording.flags & REPLAY_TRUNCATED) {
+		fprintf(stderr, "dino-sim: the game was too long for a replay, only its start was recorded\n");
+	}
+	printf("replay bytes: %d\n", REPLAY_HEADER_BYTES + recording.length);
+}
+
+/**
+ * @brief Prints the states in the rewind buffer, the lines the debug build sends over the UART.
+ *
+ * @return The number of states that did not match their check, 0 unless the game logic
+ * does not give the same state twice.
+ */
+static int print_rewind(const RewindBuffer *rewind) {
+	GameContext state;
+	char line[REWIND_LINE_BYTES];
+	uint32_t tick = rewind->first;
+	int bad = 0;
+
+	rewind_load(rewind, tick, &state);
+	rewind_format(line, tick, 0, &state, 1);
+	fputs(line, stdout);
+
+	while(tick < rewind->end) {
+		int matched = rewind_step(rewind, &state, ++tick);
+
+		rewind_format(line, tick, rewind_buttons(rewind, tick), &state, matched);
+		fputs(line, stdout);
+		bad += !matched;
+	}
+	return bad;
+}
+
+static uint64_t total_ticks(const GameResult *results) {
+	uint64_t ticks = 0;
+	long i;
+
+	for(i = 0; i < games; i++) {
+		ticks += results[i].ticks;
+	}
+	return ticks;
+}
+
+int main(int argc, char **argv) {
+	int render = 0, batched = 0, verify = 0;
+	const char *record_path = 0;
+	const char *ghost_path = 0;
+	int option;
+	long i;
+
+	while((option = getopt(argc, argv, "s:n:t:lrR:G:WAB:V")) != -1) {
+		switch(option) {
+		case 's': first_seed = strtoul(optarg, 0, 0); break;
+		case 'n': games = strtol(optarg, 0, 0); break;
+		case 't': max_ticks = strtoull(optarg, 0, 0); break;
+		case 'l': loop = 1; break;
+		case 'r': render = 1; break;
+		case 'R': record_path = optarg; break;
+		case 'G': ghost_path = optarg; break;
+		case 'W': rewinding = 1; break;
+		case 'A': piloting = 1; break;
+		case 'B': lanes = strtol(optarg, 0, 0); batched = 1; break;
+		case 'V': verify = 1; break;
+		default:
+			fprintf(stderr, "usage: %s [-s seed] [-n games] [-t ticks] [-l] [-r] [-R replay] [-G replay] [-W] [-A] [-B N] [-V] [script]\n", argv[0]);
+			return 1;
+		}
+	}
+	if(optind < argc) {
+		load_script(argv[optind], &first_seed);
+	}
+	if(loop && script_length == 0) {
+		fprintf(stderr, "dino-sim: -l needs a script\n");
+		return 1;
+	}
+	if(games < 1) {
+		fprintf(stderr, "dino-sim: games must be positive\n");
+		return 1;
+	}
+	if(batched && lanes < 1) {
+		fprintf(stderr, "dino-sim: N must be positive\n");
+		return 1;
+	}
+	if(verify && !batched) {
+		lanes = DEFAULT_LANES;
+	}
+	if((batched || verify) && (render || ghost_path || rewinding)) {
+		fprintf(stderr, "dino-sim: -r, -G and -W cannot be batched\n");
+		return 1;
+	}
+	if(ghost_path) {
+		load_ghost(ghost_path, &ghost_replay);
+		have_ghost = 1;
+	}
+
+	build_game_rules(&game_rules);
+
+	GameResult *results = calloc(games, sizeof(GameResult));
+	if(!results) {
+		fprintf(stderr, "dino-sim: out of memory\n");
+		return 1;
+	}
+
+	if(verify) {
+		double scalar_seconds, batched_seconds;
+		uint64_t ticks;
+
+		if(!race_batched(1, &scalar_seconds, &batched_seconds, &ticks)) {
+			return 1;
+		}
+		printf("verified: %ld games, %llu ticks\n", games, (unsigned long long)ticks);
+
+		race_batched(0, &scalar_seconds, &batched_seconds, &ticks);
+		printf("lanes: %d\n", lanes);
+		printf("update_game ns/tick: %.2f\n", scalar_seconds * 1e9 / ticks);
+		printf("batch_step ns/tick: %.2f\n", batched_seconds * 1e9 / ticks);
+		printf("speedup: %.2f\n", scalar_seconds / batched_seconds);
+		return 0;
+	}
+
+	double start = seconds();
+	if(batched) {
+		play_batched(results);
+	} else {
+		play_games(results, render);
+	}
+	double elapsed = seconds() - start;
+
+	// The hashes of the games are combined in order, however the games were played
+	uint64_t hash = FNV_OFFSET;
+	int best_score = 0;
+	for(i = 0; i < games; i++) {
+		int32_t words[2] = { (int32_t)results[i].hash, (int32_t)(results[i].hash >> 32) };
+		hash = hash_fields(hash, words, 2);
+		if(results[i].score > best_score) {
+			best_score = results[i].score;
+		}
+	}
+	uint64_t ticks = total_ticks(results);
+
+	printf("games: %ld\n", games);
+	printf("ticks: %llu\n", (unsigned long long)ticks);
+	printf("seconds: %.3f\n", elapsed);
+	printf("ticks/sec: %.0f\n", elapsed > 0 ? ticks / elapsed : 0.0);
+	printf("final score: %d\n", results[games - 1].score);
+	printf("best score: %d\n", best_score);
+	printf("state hash: %016llx\n", (unsigned long long)hash);
+
+	if(record_path) {
+		record_replay(record_path);
+	}
+	if(rewinding && print_rewind(&rewind_buffer) > 0) {
+		printf("rewind: states do not match their checks\n");
+		return 1;
+	}
+
+	// A replay has to play out exactly as it did when it was recorded
+	if(have_replay && !(loaded_replay.flags & REPLAY_TRUNCATED)) {
+		if(results[0].score != (int)loaded_replay.score || results[0].ticks != replay_ticks(&loaded_replay)) {
+			printf("replay: differs, recorded score %u in %u ticks\n",
+					(unsigned)loaded_replay.score, (unsigned)replay_ticks(&loaded_replay));
+			return 1;
+		}
+		printf("replay: matches\n");
+	}
+	return 0;
+}
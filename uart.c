@@ -0,0 +1,108 @@
+/**
+ * @file uart.c
+ * @brief Sending replays, and in the debug build the rewind buffer, to a computer over UART1.
+ *
+ * UART1 is wired to the USB serial port of the ChipKIT, the one the programmer uses,
+ * so a terminal on that port (115200 baud, 8N1) sees one line per finished run:
+ *
+ *     replay d5000e01...
+ *
+ * The hex digits are the replay as it is stored in the EEPROM, header first. The line
+ * can be saved to a file and played back with tools/dino-sim.
+ *
+ * @author Elias Hollstrand
+ * @author Mattias Kvist
+ *
+ * For copyright and licensing, see file COPYING.
+ */
+
+#include <stdint.h>	 /* Declarations of uint_32 and the like */
+#include <pic32mx.h> /* Declarations of system-specific addresses etc */
+#include "declare.h" /* Declatations for these labs */
+
+#define UART_BAUD 115200
+#define PERIPHERAL_CLOCK 80000000
+
+/**
+ * @brief Sets up UART1 for sending at 115200 baud, 8 data bits, no parity, 1 stop bit.
+ */
+void uart_init(void) {
+	U1MODE = 0;
+	U1BRG = PIC32_BRG_BAUD(PERIPHERAL_CLOCK, UART_BAUD);
+	U1STA = PIC32_USTA_UTXEN;     // Transmit only
+	U1MODESET = PIC32_UMODE_ON;
+}
+
+/**
+ * @brief Sends one character, waiting while the transmit buffer is full.
+ */
+void uart_putc(char c) {
+	while(U1STA & PIC32_USTA_UTXBF);
+	U1TXREG = c;
+}
+
+/**
+ * @brief Sends a string.
+ */
+void uart_puts(const char *s) {
+	while(*s) {
+		uart_putc(*s++);
+	}
+}
+
+/**
+ * @brief Sends bytes as two lowercase hex digits each.
+ */
+void uart_put_hex(const uint8_t *bytes, int count) {
+	const char *digits = "0123456789abcdef";
+	int i;
+
+	for(i = 0; i < count; i++) {
+		uart_putc(digits[bytes[i] >> 4]);
+		uart_putc(digits[bytes[i] & 0xF]);
+	}
+}
+
+/**
+ * @brief Sends a replay as one line of text.
+ *
+ * Takes about 45 ms for a replay of 250 bytes, so it is only done when a run has ended.
+ *
+ * @param replay The replay to send.
+ */
+void uart_send_replay(const Replay *replay) {
+	uint8_t header[REPLAY_HEADER_BYTES];
+
+	replay_encode_header(replay, header);
+	uart_puts("replay ");
+	uart_put_hex(header, REPLAY_HEADER_BYTES);
+	uart_put_hex(replay->runs, replay->length);
+	uart_puts("\r\n");
+}
+
+/**
+ * @brief Sends the states of the ticks in a rewind buffer, oldest first, one line each.
+ *
+ * The lines are written by rewind_format(). A state is marked BAD when rebuilding it from
+ * the one before it did not give the state that was played, which points at the tick
+ * where a glitch happened. The debug build sends this when a run ends, when a run is
+ * rewound and from the NMI handler. 256 lines take about 2 seconds.
+ *
+ * @param rewind The buffer to send.
+ */
+void uart_send_rewind(const RewindBuffer *rewind) {
+	GameContext state;
+	char line[REWIND_LINE_BYTES];
+	uint32_t tick = rewind->first;
+
+	rewind_load(rewind, tick, &state);
+	rewind_format(line, tick, 0, &state, 1);
+	uart_puts(line);
+
+	while(tick < rewind->end) {
+		int matched = rewind_step(rewind, &state, ++tick);
+
+		rewind_format(line, tick, rewind_buttons(rewind, tick), &state, matched);
+		uart_puts(line);
+	}
+}